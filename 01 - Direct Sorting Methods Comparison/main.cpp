@@ -20,7 +20,8 @@
  *          Slowest one in the Best Case, because even if the array is sorted, it has to check for each element if it
  *           really is the smallest one in the unsorted part of the array
  *          Running time is always O(n^2) due to the comparisons described above
- *          Stable, because the comparison uses strict inequality, so the equal elements won't be swapped
+ *          Not stable, the comparison uses strict inequality so the first of the equal minimums is picked, but the
+ *           swap can move array[i] behind an element equal to it ( 2a 2b 1 -> 1 2b 2a )
  *          Algorithm:
  *              We start from the left and divide the array to 2 sub-arrays, the sorted one and the unsorted one.
  *              We focus on finding the minimum from the unsorted array and swapping it with the first element from the
@@ -38,6 +39,100 @@
  *               before it to the right until the extracted element can be placed in the sorted part of the array, so
  *               that the sub-array stays sorted.
  *
+ *      *Shell Sort*
+ *          Insertion Sort extension which breaks the O(n^2) barrier while staying in-place and allocation-free (the
+ *           gaps are kept in a fixed size local array), so it's usable where the recursion of Quick Sort is unwanted
+ *          Pluggable gap sequences: Shell (n/2^k), Knuth ((3^k-1)/2), Sedgewick (4^k+3*2^(k-1)+1), Ciura and Tokuda
+ *          Best Case is O(n*log n), because each gap pass is a Best Case Insertion Sort
+ *          Worst and Average Case depend on the gaps: O(n^2) for Shell's gaps, O(n^(3/2)) for Knuth, O(n^(4/3)) for
+ *           Sedgewick, while Ciura's and Tokuda's gaps are the best known empirically ( ~O(n^(5/4)) on average )
+ *          Not stable, elements jump over equal elements when the gap is bigger than 1
+ *          Algorithm:
+ *              Runs an Insertion Sort on every gap-th element for each gap in decreasing order, the last gap is
+ *               always 1 which is a plain Insertion Sort on an almost sorted array.
+ *
+ *      *Sorting Network (Batcher's Merge Exchange)*
+ *          Data-oblivious: it does exactly the same compare-exchanges for sorted, reversed and random input, so all
+ *           three cases are identical, O(n*log^2 n) comparisons and two assignments per compare-exchange
+ *          Not stable, a compare-exchange may swap equal keys that are far from each other
+ *          Algorithm:
+ *              A fixed sequence of compare-exchange passes (Knuth 5.2.2, Algorithm M). In one pass every element takes
+ *               part in at most one compare-exchange and the pairs are (i, i + d) for runs of consecutive i-s, so the
+ *               pass is done with min/max on 8 keys at once (AVX2) when the CPU supports it, scalar otherwise.
+ *              Up to SMALL_NETWORK_MAX_SIZE keys ( with AVX2 ) the whole array is loaded into 1, 2, 4 or 8 registers
+ *               and sorted there by a bitonic network, the lanes are paired by permutes and the unused ones are padded
+ *               with INT_MAX. That's 24, 80, 240 or 672 compare-exchanges, more than Batcher's, but without a single
+ *               load or store between them. There are no data dependent branches at all, that's why it wins against
+ *               insertion sort on tiny arrays ( the same kernel is the small sort of the SIMD Quick-Sort in lab 03 ).
+ *
+ *      *Power Sort ( Natural Adaptive Merge Sort )*
+ *          Stable merge sort for run-structured data, Timsort with the Powersort merge policy
+ *          Algorithm:
+ *              Finds the runs ( strictly descending ones are reversed ), runs shorter than minrun ( 32-64 ) are extended
+ *               with Binary Insertion Sort. Each run boundary gets a power, the depth of the boundary's midpoint in a
+ *               perfectly balanced merge tree, and the runs on the stack are merged while the previous boundary is
+ *               deeper than the new one, so the merge tree is nearly optimal for the given run lengths.
+ *              Merging starts in one-at-a-time mode, if one run wins MIN_GALLOP times in a row it switches to galloping
+ *               ( exponential + binary search ) and copies whole blocks, which is what makes interleaved runs cheap.
+ *          Run Time:
+ *              O(n + n*log r) for r runs, O(n) in the Best and Worst Cases of the direct methods ( one run ),
+ *               O(n*log n) on random input. The Runs report shows the number of operations for n = 10000 as a function
+ *               of the number of runs, and it grows with log r.
+ *
+ *      *Key - Payload Sorting ( AoS vs SoA )*
+ *          Records are sorted by key with the stable Power Sort in two layouts:
+ *              Array-of-Structs:   the records are moved together with their payloads at every assignment
+ *              Struct-of-Arrays:   only ( key, index ) pairs are sorted, the payloads are moved once at the end
+ *          isStablySorted verifies that equal keys kept their original order ( the payload holds the original index ),
+ *           the stability claims of the three direct sorts are checked the same way, on Key - Payload pairs
+ *          The Layouts report shows the running time ( microseconds, 5 runs summed ): with 8 and 32 byte payloads the
+ *           two layouts are about the same, the smaller moves of SoA are paid back by the index pairs and the final
+ *           gather, with 128 byte payloads SoA is ~20-25% faster, because AoS moves 132 bytes at each of the
+ *           O(n*log n) assignments, while SoA moves them only once
+ *
+ *      *Radix Sort ( LSD and MSD )*
+ *          Non-comparison baseline for bounded integer keys ( int, unsigned long long and Key - Payload pairs )
+ *          LSD: 8, 11 or 16 bit digits, the histograms of all digits are built in a single pass, and the digits that are
+ *           the same for every key are skipped, so the keys from [100, 10000] take only 2 passes with 8 bit digits
+ *           ( 1 pass with 16 bit digits ). Stable, O(n * digits) in every case, but needs an n sized buffer
+ *          MSD ( American Flag Sort ): in-place, buckets are permuted into place by following swap cycles and then
+ *           sorted by the next digit, small buckets are finished with Insertion Sort. Not stable
+ *          The 64 bit series sort the same keys widened to unsigned long long ( the key is copied to the upper bits
+ *           too ), the 8 bit LSD Radix Sort can skip only 4 of the 8 digits there, so it does 4 passes instead of 2
+ *          Compared to the comparison sorts in the Radix_vs_Comparison groups, the comparison sorts only win in the
+ *           Best Case, where the input is already ( almost ) sorted
+ *
+ *      *Adaptive Sort ( Presortedness Analyzer + Dispatcher )*
+ *          Inputs are often nearly sorted, which is the Best Case that Bubble and Insertion Sort exploit, so before
+ *           sorting we take one pass over the array and estimate how sorted it already is:
+ *              Runs:        Maximal non-descending or strictly descending sequences ( exact )
+ *              Inversions:  Estimated from randomly sampled pairs ( fraction of inverted pairs * n*(n-1)/2 )
+ *              Duplicates:  Number of distinct keys estimated with linear counting on a small bitmap
+ *              Key Range:   Minimum and maximum, tells how many digits Radix Sort needs
+ *          The dispatcher estimates the cost of each candidate from these numbers and runs the cheapest one:
+ *              Insertion Sort      n + inversions
+ *              Natural Merge Sort  n * log(runs), descending runs are reversed, so the Worst Case is O(n) too
+ *              Quick Sort          n * log(distinct), 3-way partitioning makes duplicates cheap
+ *              Radix Sort          n * digits, non-comparison, for bounded integer keys
+ *          The analysis costs n comparisons plus a constant number of samples, the gain over any fixed algorithm
+ *           is shown in the Adaptive_Gain groups of each case.
+ *
+ *      *Branchless Selection and Insertion Kernels*
+ *          Branch-free versions of the two kernels, to see which direct sort is really limited by branch prediction.
+ *          Selection Sort Branchless: the minimum and its index are tracked with masks ( -(a < b) ), no branch depends
+ *           on the data, the compiler turns it into conditional moves
+ *          Selection Sort Vectorized: the argmin is searched on 8 lanes with AVX2 ( compare + min + blend of the
+ *           indexes ), if AVX2 is not available it falls back to the branchless version
+ *          Insertion Sort Branchless: the place of the element is found with a branchless binary search ( the number of
+ *           steps only depends on i ), then the elements are shifted with memmove
+ *          The Branches report counts the hardware branch misses ( Linux perf events, if the machine allows them ) and
+ *           the running time of the kernels without the operation counters:
+ *              Selection Sort is NOT limited by branch prediction: a new minimum is rare ( ~ln n times per pass ), so the
+ *               branch is well predicted and the scalar branchless version is ~3x slower, because every step waits for
+ *               the previous mask. Only the vectorized argmin helps ( ~4x faster ), by doing 8 comparisons at once.
+ *              Insertion Sort misses about once per element ( the exit of the inner loop ), the branchless binary search
+ *               removes it and memmove shifts the elements much faster, it's the fastest of the kernels ( ~7x at 10000 )
+ *
  *      *Final Notes*
  *          Personally I would choose the Insertion Sort, due to the fact, that it does better than the Bubble Sort in
  *           the Worst Case, but also in the Best Case takes a good running time.
@@ -63,16 +158,41 @@
  */
 
 #include <iostream>
+#include <vector>
+#include <bitset>
+#include <chrono>
+#include <math.h>
+#include <climits>
 #include "Profiler.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #define MAX_SIZE 10000
+#define MAX_GAPS 64
+#define INSERTION_CUTOFF 16
+#define SMALL_NETWORK_MAX_SIZE 64
+#define INVERSION_SAMPLES 256
+#define DISTINCT_BITMAP_SIZE 4096
+#define MIN_GALLOP 7
+#define MAX_PENDING_RUNS 64
 
 Profiler profiler("Direct_Sorting_Method_Comparisons_Best_Case");
 
 using namespace std;
 
 
-void printArray(int array[], int arraySize) {
+template <typename T>
+void printArray(T array[], int arraySize) {
     for (int i = 0; i < arraySize; i++) {
         cout << array[i] << " ";
     }
@@ -80,13 +200,31 @@ void printArray(int array[], int arraySize) {
 }
 
 
+/** Key - Payload pair, sorted by key only
+ */
+typedef struct {
+    int key;
+    int payload;
+} KeyPayload;
+
+/** Key used by the direct sorts and the stable merge sorts, the elements are ordered by it only
+ */
+inline int sortKey(int x) {
+    return x;
+}
+
+inline int sortKey(const KeyPayload &x) {
+    return x.key;
+}
+
 /** Sorts a given algorithm in increasing order
  *  Method implemented: Bubble Sort
  *
- * @param array - Array of type Int
+ * @param array - Array of type Int, or Key - Payload pairs
  * @param arraySize - Size of Array
  */
-void bubbleSort(int array[], int arraySize) {
+template <typename T>
+void bubbleSort(T array[], int arraySize) {
     bool isSorted;
     int i = 0;
     int k = arraySize;
@@ -95,7 +233,7 @@ void bubbleSort(int array[], int arraySize) {
         isSorted = true;
         for (i = 0; i < k - 1; i++) {
             profiler.countOperation("Bub_Sort_Comp", arraySize);
-            if (array[i] > array[i + 1]) {
+            if (sortKey(array[i]) > sortKey(array[i + 1])) {
                 profiler.countOperation("Bub_Sort_Assig", arraySize, 4);
                 isSorted = false;
                 swap(array[i], array[i + 1]);
@@ -112,14 +250,15 @@ void bubbleSort(int array[], int arraySize) {
  * @param array
  * @param arraySize
  */
-void selectionSort(int array[], int arraySize) {
+template <typename T>
+void selectionSort(T array[], int arraySize) {
     int currentMinimum, i, j;
     for (i = 0; i < arraySize - 1; i++) {
         profiler.countOperation("Sel_Sort_Assig", arraySize);
         currentMinimum = i;
         for (j = i + 1; j < arraySize; j++) {
             profiler.countOperation("Sel_Sort_Comp", arraySize);
-            if (array[j] < array[currentMinimum]) {
+            if (sortKey(array[j]) < sortKey(array[currentMinimum])) {
                 profiler.countOperation("Sel_Sort_Assig", arraySize);
                 currentMinimum = j;
             }
@@ -135,13 +274,15 @@ void selectionSort(int array[], int arraySize) {
  * @param array
  * @param arraySize
  */
-void insertionSort(int array[], int arraySize) {
-    int temp, i, j;
+template <typename T>
+void insertionSort(T array[], int arraySize) {
+    T temp;
+    int i, j;
     for (i = 1; i < arraySize; i++) {
         temp = array[i];
         j = i - 1;
         profiler.countOperation("Ins_Sort_Assig", arraySize, 2);
-        while (j >= 0 && array[j] > temp) {
+        while (j >= 0 && sortKey(array[j]) > sortKey(temp)) {
             profiler.countOperation("Ins_Sort_Comp", arraySize);
             profiler.countOperation("Ins_Sort_Assig", arraySize, 2);
             array[j + 1] = array[j];
@@ -153,6 +294,471 @@ void insertionSort(int array[], int arraySize) {
     }
 }
 
+enum GapSequence {
+    SHELL_GAPS = 0, KNUTH_GAPS, SEDGEWICK_GAPS, CIURA_GAPS, TOKUDA_GAPS
+};
+
+#define NR_GAP_SEQUENCES 5
+
+const char *shellSortAssig[NR_GAP_SEQUENCES] = {"Shl_Shell_Assig", "Shl_Knuth_Assig", "Shl_Sedgewick_Assig",
+                                                "Shl_Ciura_Assig", "Shl_Tokuda_Assig"};
+const char *shellSortComp[NR_GAP_SEQUENCES] = {"Shl_Shell_Comp", "Shl_Knuth_Comp", "Shl_Sedgewick_Comp",
+                                               "Shl_Ciura_Comp", "Shl_Tokuda_Comp"};
+const char *shellSortTotal[NR_GAP_SEQUENCES] = {"Shell_Sort_Shell", "Shell_Sort_Knuth", "Shell_Sort_Sedgewick",
+                                                "Shell_Sort_Ciura", "Shell_Sort_Tokuda"};
+
+/** Fills gaps with the gap sequence smaller than arraySize, in decreasing order ( the last one is always 1 )
+ *
+ * @param sequence      Which gap sequence to generate
+ * @param arraySize
+ * @param gaps          Array of at least MAX_GAPS elements
+ * @return              Number of gaps generated
+ */
+int generateGaps(GapSequence sequence, int arraySize, int gaps[]) {
+    static const int ciuraGaps[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+    int nrGaps = 0;
+    long long gap = 1;
+    switch (sequence) {
+        case SHELL_GAPS:
+            for (gap = arraySize / 2; gap > 0; gap /= 2) {
+                gaps[nrGaps++] = (int) gap;
+            }
+            return nrGaps;
+        case KNUTH_GAPS:
+            for (gap = 1; gap == 1 || gap < arraySize / 3; gap = 3 * gap + 1) {
+                gaps[nrGaps++] = (int) gap;
+            }
+            break;
+        case SEDGEWICK_GAPS:
+            gaps[nrGaps++] = 1;
+            for (int k = 1; (gap = (1LL << (2 * k)) + 3 * (1LL << (k - 1)) + 1) < arraySize; k++) {
+                gaps[nrGaps++] = (int) gap;
+            }
+            break;
+        case CIURA_GAPS:
+            for (int k = 0; (gap = k < 9 ? ciuraGaps[k] : gap * 9 / 4) == 1 || gap < arraySize; k++) {
+                gaps[nrGaps++] = (int) gap;
+            }
+            break;
+        case TOKUDA_GAPS: {
+            double h = 1;
+            for (gap = 1; gap == 1 || gap < arraySize; gap = (long long) ceil((9 * h - 4) / 5)) {
+                gaps[nrGaps++] = (int) gap;
+                h *= 2.25;
+            }
+            break;
+        }
+    }
+    reverse(gaps, gaps + nrGaps);
+    return nrGaps;
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Shell Sort ( Insertion Sort on gap-th elements, for decreasing gaps )
+ *
+ * @param array
+ * @param arraySize
+ * @param sequence      Gap sequence to use
+ */
+void shellSort(int array[], int arraySize, GapSequence sequence) {
+    int gaps[MAX_GAPS];
+    int nrGaps = generateGaps(sequence, arraySize, gaps);
+    int temp, i, j;
+    for (int g = 0; g < nrGaps; g++) {
+        int gap = gaps[g];
+        for (i = gap; i < arraySize; i++) {
+            temp = array[i];
+            j = i - gap;
+            profiler.countOperation(shellSortAssig[sequence], arraySize, 2);
+            while (j >= 0 && array[j] > temp) {
+                profiler.countOperation(shellSortComp[sequence], arraySize);
+                profiler.countOperation(shellSortAssig[sequence], arraySize, 2);
+                array[j + gap] = array[j];
+                j -= gap;
+            }
+            profiler.countOperation(shellSortComp[sequence], arraySize);
+            profiler.countOperation(shellSortAssig[sequence], arraySize);
+            array[j + gap] = temp;
+        }
+    }
+}
+
+/** Compare-exchanges array[i] with array[i + distance] for every i in [from, to)
+ *  Scalar version, branchless ( min/max compile to conditional moves )
+ *
+ * @param array
+ * @param from          First index of the run
+ * @param to            Last index of the run ( exclusive )
+ * @param distance      Distance between the two elements of a pair
+ */
+void compareExchangeRangeScalar(int array[], int from, int to, int distance) {
+    for (int i = from; i < to; i++) {
+        int x = array[i];
+        int y = array[i + distance];
+        array[i] = x < y ? x : y;
+        array[i + distance] = x < y ? y : x;
+    }
+}
+
+#ifdef HAS_X86_SIMD
+/** Same as compareExchangeRangeScalar, but 8 pairs at once
+ *  The run [from, to) and its pairs [from + distance, to + distance) never overlap inside a network pass
+ */
+__attribute__((target("avx2")))
+void compareExchangeRangeAvx2(int array[], int from, int to, int distance) {
+    int i = from;
+    for (; i + 8 <= to; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (array + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *) (array + i + distance));
+        _mm256_storeu_si256((__m256i *) (array + i), _mm256_min_epi32(x, y));
+        _mm256_storeu_si256((__m256i *) (array + i + distance), _mm256_max_epi32(x, y));
+    }
+    compareExchangeRangeScalar(array, i, to, distance);
+}
+
+__attribute__((target("avx2"))) inline void minMaxAvx2(__m256i &low, __m256i &high) {
+    __m256i minimum = _mm256_min_epi32(low, high);
+    high = _mm256_max_epi32(low, high);
+    low = minimum;
+}
+
+/** Compare-exchange of every lane i with the lane permutation[i] of the same vector, the lanes set in maxLanes keep
+ *  the maximum of the pair and the others the minimum
+ */
+template<int maxLanes>
+__attribute__((target("avx2"))) inline __m256i exchangeLanesAvx2(__m256i v, __m256i permutation) {
+    __m256i low = v, high = _mm256_permutevar8x32_epi32(v, permutation);
+    minMaxAvx2(low, high);
+    return _mm256_blend_epi32(low, high, maxLanes);
+}
+
+/** Bitonic sort of the 8 lanes of a vector: the pairs, the quadruples and the whole vector are merged, each merge
+ *  starts by comparing the lanes with their mirror ( the flip ) and continues with half-cleaners
+ */
+__attribute__((target("avx2"))) inline __m256i sortLanesAvx2(__m256i v) {
+    __m256i swapPairs = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    v = exchangeLanesAvx2<0xAA>(v, swapPairs);
+    v = exchangeLanesAvx2<0xCC>(v, _mm256_setr_epi32(3, 2, 1, 0, 7, 6, 5, 4));
+    v = exchangeLanesAvx2<0xAA>(v, swapPairs);
+    v = exchangeLanesAvx2<0xF0>(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    v = exchangeLanesAvx2<0xCC>(v, _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5));
+    return exchangeLanesAvx2<0xAA>(v, swapPairs);
+}
+
+/** The half-cleaners inside a vector at distances 4, 2 and 1, the last steps of every merge
+ */
+__attribute__((target("avx2"))) inline __m256i mergeLanesAvx2(__m256i v) {
+    v = exchangeLanesAvx2<0xF0>(v, _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3));
+    v = exchangeLanesAvx2<0xCC>(v, _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5));
+    return exchangeLanesAvx2<0xAA>(v, _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6));
+}
+
+/** Bitonic sort of 8 * R keys held in R registers. Every register is sorted on its own, then the groups of 2, 4, ...
+ *  registers are merged: the flip compares a register with the reversed mirror register, the half-cleaners at
+ *  distances of whole registers are plain min / max of two registers, the rest is done inside the registers.
+ */
+template<int R>
+__attribute__((target("avx2"))) inline void sortRegistersAvx2(__m256i v[]) {
+    __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    for (int i = 0; i < R; i++) {
+        v[i] = sortLanesAvx2(v[i]);
+    }
+    for (int size = 2; size <= R; size <<= 1) {
+        for (int block = 0; block < R; block += size) {
+            for (int j = 0; j < size / 2; j++) {
+                __m256i high = _mm256_permutevar8x32_epi32(v[block + size - 1 - j], reverse);
+                minMaxAvx2(v[block + j], high);
+                v[block + size - 1 - j] = _mm256_permutevar8x32_epi32(high, reverse);
+            }
+        }
+        for (int distance = size / 4; distance > 0; distance >>= 1) {
+            for (int i = 0; i < R; i++) {
+                if ((i & distance) == 0) {
+                    minMaxAvx2(v[i], v[i + distance]);
+                }
+            }
+        }
+        for (int i = 0; i < R; i++) {
+            v[i] = mergeLanesAvx2(v[i]);
+        }
+    }
+}
+
+/** Sorts array[0..arraySize-1], arraySize <= 8 * R, in R registers. The lanes after arraySize are padded with INT_MAX,
+ *  every compare-exchange puts the minimum on the lower lane, so the padding never moves and masked stores write
+ *  back exactly arraySize keys.
+ */
+template<int R>
+__attribute__((target("avx2"))) void registerNetworkSortAvx2(int array[], int arraySize) {
+    __m256i v[R], masks[R];
+    __m256i padding = _mm256_set1_epi32(INT_MAX);
+    for (int i = 0; i < R; i++) {
+        masks[i] = _mm256_cmpgt_epi32(_mm256_set1_epi32(arraySize - 8 * i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        v[i] = _mm256_blendv_epi8(padding, _mm256_maskload_epi32(array + 8 * i, masks[i]), masks[i]);
+    }
+    sortRegistersAvx2<R>(v);
+    for (int i = 0; i < R; i++) {
+        _mm256_maskstore_epi32(array + 8 * i, masks[i], v[i]);
+    }
+}
+#endif
+
+bool hasAvx2() {
+#ifdef HAS_X86_SIMD
+    static bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Sorting Network ( bitonic in registers up to SMALL_NETWORK_MAX_SIZE keys, Batcher's Merge
+ *  Exchange above ), uses AVX2 if available
+ *
+ * @param array
+ * @param arraySize
+ */
+void networkSort(int array[], int arraySize) {
+    if (arraySize < 2) {
+        return;
+    }
+#ifdef HAS_X86_SIMD
+    if (arraySize <= SMALL_NETWORK_MAX_SIZE && hasAvx2()) {
+        // 4 * R compare-exchanges per step on the 8 * R padded keys, m * (m + 1) / 2 steps for m = log2(8 * R)
+        int registers = arraySize <= 8 ? 1 : arraySize <= 16 ? 2 : arraySize <= 32 ? 4 : 8;
+        int steps = registers == 1 ? 6 : registers == 2 ? 10 : registers == 4 ? 15 : 21;
+        profiler.countOperation("Net_Sort_Comp", arraySize, 4 * registers * steps);
+        profiler.countOperation("Net_Sort_Assig", arraySize, 8 * registers * steps);
+        if (registers == 1) {
+            registerNetworkSortAvx2<1>(array, arraySize);
+        } else if (registers == 2) {
+            registerNetworkSortAvx2<2>(array, arraySize);
+        } else if (registers == 4) {
+            registerNetworkSortAvx2<4>(array, arraySize);
+        } else {
+            registerNetworkSortAvx2<8>(array, arraySize);
+        }
+        return;
+    }
+#endif
+    int top = 1;
+    while (top < arraySize) {
+        top <<= 1;
+    }
+    top >>= 1;
+    bool vectorized = hasAvx2();
+    for (int p = top; p > 0; p >>= 1) {
+        int q = top;
+        int r = 0;
+        int d = p;
+        while (true) {
+            for (int base = r; base < arraySize - d; base += 2 * p) {
+                int end = min(base + p, arraySize - d);
+                profiler.countOperation("Net_Sort_Comp", arraySize, end - base);
+                profiler.countOperation("Net_Sort_Assig", arraySize, 2 * (end - base));
+#ifdef HAS_X86_SIMD
+                if (vectorized) {
+                    compareExchangeRangeAvx2(array, base, end, d);
+                    continue;
+                }
+#endif
+                compareExchangeRangeScalar(array, base, end, d);
+            }
+            if (q == p) {
+                break;
+            }
+            d = q - p;
+            q >>= 1;
+            r = p;
+        }
+    }
+}
+
+/** Hardware branch miss counter of the calling thread ( Linux perf events )
+ *  available() is false if the kernel or the machine doesn't allow it, then stop() always returns 0
+ */
+class BranchMissCounter {
+public:
+    BranchMissCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        fd = (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+    }
+
+    ~BranchMissCounter() {
+#ifdef __linux__
+        if (fd != -1) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool available() const {
+        return fd != -1;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+        long long misses = 0;
+#ifdef __linux__
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) {
+                misses = 0;
+            }
+        }
+#endif
+        return misses;
+    }
+
+private:
+    int fd;
+};
+
+/** Selection Sort and Insertion Sort without the operation counters, the baselines of the branchless kernels
+ */
+void selectionSortBranchy(int array[], int arraySize) {
+    for (int i = 0; i < arraySize - 1; i++) {
+        int currentMinimum = i;
+        for (int j = i + 1; j < arraySize; j++) {
+            if (array[j] < array[currentMinimum]) {
+                currentMinimum = j;
+            }
+        }
+        swap(array[i], array[currentMinimum]);
+    }
+}
+
+void insertionSortBranchy(int array[], int arraySize) {
+    for (int i = 1; i < arraySize; i++) {
+        int temp = array[i];
+        int j = i - 1;
+        while (j >= 0 && array[j] > temp) {
+            array[j + 1] = array[j];
+            j--;
+        }
+        array[j + 1] = temp;
+    }
+}
+
+/** Index of the first minimum of array[from..to-1], the minimum is tracked with masks instead of branches
+ */
+int argminBranchless(const int array[], int from, int to) {
+    int best = from;
+    int bestValue = array[from];
+    for (int j = from + 1; j < to; j++) {
+        int value = array[j];
+        int smaller = -(value < bestValue);
+        best = (j & smaller) | (best & ~smaller);
+        bestValue = (value & smaller) | (bestValue & ~smaller);
+    }
+    return best;
+}
+
+#ifdef HAS_X86_SIMD
+/** Same as argminBranchless, 8 lanes at once, every lane keeps its own first minimum and index
+ */
+__attribute__((target("avx2")))
+int argminAvx2(const int array[], int from, int to) {
+    if (to - from < 16) {
+        return argminBranchless(array, from, to);
+    }
+    __m256i minValues = _mm256_loadu_si256((const __m256i *) (array + from));
+    __m256i indexes = _mm256_add_epi32(_mm256_set1_epi32(from), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i minIndexes = indexes;
+    __m256i eight = _mm256_set1_epi32(8);
+    int i = from + 8;
+    for (; i + 8 <= to; i += 8) {
+        indexes = _mm256_add_epi32(indexes, eight);
+        __m256i values = _mm256_loadu_si256((const __m256i *) (array + i));
+        __m256i smaller = _mm256_cmpgt_epi32(minValues, values);
+        minValues = _mm256_min_epi32(minValues, values);
+        minIndexes = _mm256_blendv_epi8(minIndexes, indexes, smaller);
+    }
+    int laneValues[8], laneIndexes[8];
+    _mm256_storeu_si256((__m256i *) laneValues, minValues);
+    _mm256_storeu_si256((__m256i *) laneIndexes, minIndexes);
+    int best = laneIndexes[0];
+    for (int lane = 1; lane < 8; lane++) {
+        if (laneValues[lane] < array[best] || (laneValues[lane] == array[best] && laneIndexes[lane] < best)) {
+            best = laneIndexes[lane];
+        }
+    }
+    for (; i < to; i++) {
+        int smaller = -(array[i] < array[best]);
+        best = (i & smaller) | (best & ~smaller);
+    }
+    return best;
+}
+#endif
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Selection Sort with a branchless argmin
+ *
+ * @param array
+ * @param arraySize
+ */
+void selectionSortBranchless(int array[], int arraySize) {
+    for (int i = 0; i < arraySize - 1; i++) {
+        swap(array[i], array[argminBranchless(array, i, arraySize)]);
+    }
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Selection Sort with an AVX2 argmin ( branchless argmin if AVX2 is not available )
+ *
+ * @param array
+ * @param arraySize
+ */
+void selectionSortVectorized(int array[], int arraySize) {
+#ifdef HAS_X86_SIMD
+    if (hasAvx2()) {
+        for (int i = 0; i < arraySize - 1; i++) {
+            swap(array[i], array[argminAvx2(array, i, arraySize)]);
+        }
+        return;
+    }
+#endif
+    selectionSortBranchless(array, arraySize);
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Insertion Sort with a branchless binary search, stable
+ *
+ * @param array
+ * @param arraySize
+ */
+void insertionSortBranchless(int array[], int arraySize) {
+    for (int i = 1; i < arraySize; i++) {
+        int temp = array[i];
+        int position = 0;
+        for (int length = i; length > 1; length -= length / 2) {
+            int half = length / 2;
+            position += half & -(array[position + half] <= temp);
+        }
+        position += array[position] <= temp;
+        memmove(array + position + 1, array + position, (i - position) * sizeof(int));
+        array[position] = temp;
+    }
+}
+
 /** Copies an array to another
  *
  * @param origin        Original array which contains data
@@ -163,25 +769,1062 @@ void copyArray(int origin[], int destination[], int size) {
     memcpy(destination, origin, size * sizeof(int));
 }
 
-void runTests(int a[], int b[], int c[], int n, int sorted) {
+/** Sorts array[low..high] in increasing order, same as insertionSort, but for a sub-array
+ *
+ * @param array
+ * @param low           First index
+ * @param high          Last index ( inclusive )
+ * @param assig         Operation counting assignments
+ * @param comp          Operation counting comparisons
+ */
+void insertionSortRange(int array[], int low, int high, Operation assig, Operation comp) {
+    int temp, i, j;
+    for (i = low + 1; i <= high; i++) {
+        temp = array[i];
+        j = i - 1;
+        assig.count(2);
+        while (j >= low && array[j] > temp) {
+            comp.count();
+            assig.count(2);
+            array[j + 1] = array[j];
+            j--;
+        }
+        comp.count();
+        assig.count();
+        array[j + 1] = temp;
+    }
+}
+
+/** Merges the sorted array[low..mid-1] and array[mid..high-1], stable
+ *  Only the left part is moved to the buffer
+ */
+void mergeRuns(int array[], int low, int mid, int high, vector<int> &buffer, Operation assig, Operation comp) {
+    int leftSize = mid - low;
+    copy(array + low, array + mid, buffer.begin());
+    assig.count(leftSize);
+    int i = 0, j = mid, k = low;
+    while (i < leftSize && j < high) {
+        comp.count();
+        if (array[j] < buffer[i]) {
+            array[k++] = array[j++];
+        } else {
+            array[k++] = buffer[i++];
+        }
+        assig.count();
+    }
+    while (i < leftSize) {
+        assig.count();
+        array[k++] = buffer[i++];
+    }
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Natural Merge Sort ( merges the runs that are already in the array )
+ *  Strictly descending runs are reversed first, so the Worst Case of the direct methods is one run as well
+ *
+ * @param array
+ * @param arraySize
+ * @param assig
+ * @param comp
+ */
+void naturalMergeSort(int array[], int arraySize, Operation assig, Operation comp) {
+    vector<int> runStarts;
+    int i = 0;
+    while (i < arraySize) {
+        runStarts.push_back(i);
+        int j = i + 1;
+        if (j < arraySize) {
+            comp.count();
+            if (array[j] < array[i]) {
+                while (j + 1 < arraySize && array[j + 1] < array[j]) {
+                    comp.count();
+                    j++;
+                }
+                reverse(array + i, array + j + 1);
+                assig.count(3 * ((j + 1 - i) / 2));
+            } else {
+                while (j + 1 < arraySize && array[j + 1] >= array[j]) {
+                    comp.count();
+                    j++;
+                }
+            }
+            if (j + 1 < arraySize) {
+                comp.count();
+            }
+        }
+        i = j + 1;
+    }
+    runStarts.push_back(arraySize);
+    vector<int> buffer(arraySize);
+    while (runStarts.size() > 2) {
+        vector<int> merged;
+        unsigned int r;
+        for (r = 0; r + 2 < runStarts.size(); r += 2) {
+            mergeRuns(array, runStarts[r], runStarts[r + 1], runStarts[r + 2], buffer, assig, comp);
+            merged.push_back(runStarts[r]);
+        }
+        if (r + 1 < runStarts.size()) {
+            merged.push_back(runStarts[r]);
+        }
+        merged.push_back(arraySize);
+        runStarts.swap(merged);
+    }
+}
+
+/** Sorts array[low..high] in increasing order
+ *  Method implemented: Quick Sort with median of 3 pivot and 3-way ( Dijkstra ) partitioning
+ *  Keys equal to the pivot are never touched again, the smaller side is sorted recursively, the bigger one in the loop
+ */
+void quickSort3Way(int array[], int low, int high, Operation assig, Operation comp) {
+    while (high - low + 1 > INSERTION_CUTOFF) {
+        int mid = low + (high - low) / 2;
+        int x = array[low], y = array[mid], z = array[high];
+        comp.count(3);
+        int pivot = max(min(x, y), min(max(x, y), z));
+        assig.count();
+        int lt = low, i = low, gt = high;
+        while (i <= gt) {
+            comp.count();
+            if (array[i] < pivot) {
+                assig.count(3);
+                swap(array[lt++], array[i++]);
+            } else {
+                comp.count();
+                if (array[i] > pivot) {
+                    assig.count(3);
+                    swap(array[i], array[gt--]);
+                } else {
+                    i++;
+                }
+            }
+        }
+        if (lt - low < high - gt) {
+            quickSort3Way(array, low, lt - 1, assig, comp);
+            low = gt + 1;
+        } else {
+            quickSort3Way(array, gt + 1, high, assig, comp);
+            high = lt - 1;
+        }
+    }
+    insertionSortRange(array, low, high, assig, comp);
+}
+
+/** Number of elements at the start of array[0..length-1] which are <= key ( galloping from the left )
+ */
+template <typename T>
+int gallopRight(int key, const T array[], int length, Operation comp) {
+    int last = 0, offset = 1;
+    while (offset <= length) {
+        comp.count();
+        if (key < sortKey(array[offset - 1])) {
+            break;
+        }
+        last = offset;
+        offset = 2 * offset + 1;
+    }
+    int high = min(offset, length + 1) - 1;
+    while (last < high) {
+        int mid = last + (high - last) / 2;
+        comp.count();
+        if (key < sortKey(array[mid])) {
+            high = mid;
+        } else {
+            last = mid + 1;
+        }
+    }
+    return last;
+}
+
+/** Number of elements at the start of array[0..length-1] which are < key ( galloping from the left )
+ */
+template <typename T>
+int gallopLeft(int key, const T array[], int length, Operation comp) {
+    int last = 0, offset = 1;
+    while (offset <= length) {
+        comp.count();
+        if (sortKey(array[offset - 1]) >= key) {
+            break;
+        }
+        last = offset;
+        offset = 2 * offset + 1;
+    }
+    int high = min(offset, length + 1) - 1;
+    while (last < high) {
+        int mid = last + (high - last) / 2;
+        comp.count();
+        if (sortKey(array[mid]) < key) {
+            last = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return last;
+}
+
+/** Sorts array[low..high-1] with Binary Insertion Sort, knowing that array[low..start-1] is already sorted
+ *  Stable, the new element goes after the equal ones
+ */
+template <typename T>
+void binaryInsertionSort(T array[], int low, int start, int high, Operation assig, Operation comp) {
+    for (int i = max(start, low + 1); i < high; i++) {
+        T pivot = array[i];
+        int left = low, right = i;
+        while (left < right) {
+            int mid = left + (right - left) / 2;
+            comp.count();
+            if (sortKey(pivot) < sortKey(array[mid])) {
+                right = mid;
+            } else {
+                left = mid + 1;
+            }
+        }
+        move_backward(array + left, array + i, array + i + 1);
+        array[left] = pivot;
+        assig.count(i - left + 2);
+    }
+}
+
+/** Merges the sorted array[base1..base1+len1-1] and array[base1+len1..base1+len1+len2-1], stable, with galloping
+ *
+ * @param minGallop     How many wins in a row switch to galloping, adapted to the data from merge to merge
+ */
+template <typename T>
+void gallopingMerge(T array[], int base1, int len1, int len2, vector<T> &buffer, int &minGallop,
+                    Operation assig, Operation comp) {
+    int base2 = base1 + len1;
+    int skip = gallopRight(sortKey(array[base2]), array + base1, len1, comp);
+    base1 += skip;
+    len1 -= skip;
+    if (len1 == 0) {
+        return;
+    }
+    len2 = gallopLeft(sortKey(array[base2 - 1]), array + base2, len2, comp);
+    if (len2 == 0) {
+        return;
+    }
+
+    copy(array + base1, array + base2, buffer.begin());
+    assig.count(len1);
+    int a = 0, b = base2, end = base2 + len2, dest = base1;
+    while (a < len1 && b < end) {
+        int winsA = 0, winsB = 0;
+        while (a < len1 && b < end && winsA < minGallop && winsB < minGallop) {
+            comp.count();
+            assig.count();
+            if (sortKey(array[b]) < sortKey(buffer[a])) {
+                array[dest++] = array[b++];
+                winsB++;
+                winsA = 0;
+            } else {
+                array[dest++] = buffer[a++];
+                winsA++;
+                winsB = 0;
+            }
+        }
+        if (a == len1 || b == end) {
+            break;
+        }
+        bool galloping = true;
+        while (galloping) {
+            winsA = gallopRight(sortKey(array[b]), buffer.data() + a, len1 - a, comp);
+            copy(buffer.begin() + a, buffer.begin() + a + winsA, array + dest);
+            assig.count(winsA);
+            dest += winsA;
+            a += winsA;
+            if (a == len1) {
+                break;
+            }
+            assig.count();
+            array[dest++] = array[b++];
+            if (b == end) {
+                break;
+            }
+            winsB = gallopLeft(sortKey(buffer[a]), array + b, end - b, comp);
+            copy(array + b, array + b + winsB, array + dest);
+            assig.count(winsB + 1);
+            dest += winsB;
+            b += winsB;
+            array[dest++] = buffer[a++];
+            minGallop = max(1, minGallop - 1);
+            galloping = a < len1 && b < end && (winsA >= MIN_GALLOP || winsB >= MIN_GALLOP);
+        }
+        minGallop++;
+    }
+    copy(buffer.begin() + a, buffer.begin() + len1, array + dest);
+    assig.count(len1 - a);
+}
+
+/** Depth of the midpoint between the runs [s1, s1+n1) and [s1+n1, s1+n1+n2) in a balanced merge tree of n elements
+ */
+int nodePower(int s1, int n1, int n2, int n) {
+    long long a = 2LL * s1 + n1;
+    long long b = a + n1 + n2;
+    int power = 0;
+    while (true) {
+        power++;
+        if (a >= n) {
+            a -= n;
+            b -= n;
+        } else if (b >= n) {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+/** Runs shorter than this are extended with Binary Insertion Sort, it's between 32 and 64 and n / minrun is
+ *  close to, but not more than, a power of 2
+ */
+int computeMinRun(int n) {
+    int remainder = 0;
+    while (n >= 64) {
+        remainder |= n & 1;
+        n >>= 1;
+    }
+    return n + remainder;
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Power Sort ( natural adaptive merge sort, Timsort with the Powersort merge policy ), stable
+ *
+ * @param array         int, or any element type with a sortKey overload
+ * @param arraySize
+ * @param assig
+ * @param comp
+ */
+template <typename T>
+void powerSort(T array[], int arraySize, Operation assig, Operation comp) {
+    if (arraySize < 2) {
+        return;
+    }
+    int runBase[MAX_PENDING_RUNS], runLength[MAX_PENDING_RUNS], runPower[MAX_PENDING_RUNS];
+    int nrRuns = 0;
+    int minRun = computeMinRun(arraySize);
+    int minGallop = MIN_GALLOP;
+    vector<T> buffer(arraySize);
+    int low = 0;
+    while (low < arraySize) {
+        int high = low + 1;
+        if (high < arraySize) {
+            comp.count();
+            if (sortKey(array[high]) < sortKey(array[low])) {
+                while (high + 1 < arraySize && sortKey(array[high + 1]) < sortKey(array[high])) {
+                    comp.count();
+                    high++;
+                }
+                reverse(array + low, array + high + 1);
+                assig.count(3 * ((high + 1 - low) / 2));
+            } else {
+                while (high + 1 < arraySize && sortKey(array[high + 1]) >= sortKey(array[high])) {
+                    comp.count();
+                    high++;
+                }
+            }
+            high++;
+        }
+        if (high - low < minRun) {
+            int forced = min(arraySize, low + minRun);
+            binaryInsertionSort(array, low, high, forced, assig, comp);
+            high = forced;
+        }
+        if (nrRuns > 0) {
+            int power = nodePower(runBase[nrRuns - 1], runLength[nrRuns - 1], high - low, arraySize);
+            while (nrRuns > 1 && runPower[nrRuns - 2] > power) {
+                gallopingMerge(array, runBase[nrRuns - 2], runLength[nrRuns - 2], runLength[nrRuns - 1], buffer,
+                               minGallop, assig, comp);
+                runLength[nrRuns - 2] += runLength[nrRuns - 1];
+                nrRuns--;
+            }
+            runPower[nrRuns - 1] = power;
+        }
+        runBase[nrRuns] = low;
+        runLength[nrRuns] = high - low;
+        nrRuns++;
+        low = high;
+    }
+    while (nrRuns > 1) {
+        gallopingMerge(array, runBase[nrRuns - 2], runLength[nrRuns - 2], runLength[nrRuns - 1], buffer, minGallop,
+                       assig, comp);
+        runLength[nrRuns - 2] += runLength[nrRuns - 1];
+        nrRuns--;
+    }
+}
+
+/** Fills the array with nrRuns sorted runs of ( almost ) equal length, random values
+ */
+void fillRuns(int array[], int n, int nrRuns) {
+    FillRandomArray(array, n, 100, 10000, false, 0);
+    for (int r = 0; r < nrRuns; r++) {
+        sort(array + (long long) r * n / nrRuns, array + (long long) (r + 1) * n / nrRuns);
+    }
+}
+
+/** Payload of PAYLOAD_BYTES bytes, the first 4 bytes hold the original position of the record, so that
+ *  stability can be verified after sorting
+ */
+template <int PAYLOAD_BYTES>
+struct Payload {
+    char bytes[PAYLOAD_BYTES];
+};
+
+/** Array-of-Structs layout, the key and the payload are moved together
+ */
+template <int PAYLOAD_BYTES>
+struct Record {
+    int key;
+    Payload<PAYLOAD_BYTES> payload;
+};
+
+template <int PAYLOAD_BYTES>
+inline int sortKey(const Record<PAYLOAD_BYTES> &x) {
+    return x.key;
+}
+
+template <int PAYLOAD_BYTES>
+inline int originalIndex(const Payload<PAYLOAD_BYTES> &x) {
+    int index;
+    memcpy(&index, x.bytes, sizeof(int));
+    return index;
+}
+
+template <int PAYLOAD_BYTES>
+void makePayload(Payload<PAYLOAD_BYTES> &x, int index) {
+    memset(x.bytes, 0, PAYLOAD_BYTES);
+    memcpy(x.bytes, &index, sizeof(int));
+}
+
+/** Sorts the records by key, stable
+ *  Array-of-Structs: Power Sort moves the whole records
+ *
+ * @param records
+ * @param n
+ * @param assig
+ * @param comp
+ */
+template <int PAYLOAD_BYTES>
+void stableSortAoS(Record<PAYLOAD_BYTES> records[], int n, Operation assig, Operation comp) {
+    powerSort(records, n, assig, comp);
+}
+
+/** Sorts keys[] and payloads[] by the keys, stable
+ *  Struct-of-Arrays: Power Sort moves only ( key, index ) pairs, the payloads are moved once at the end, following
+ *   the permutation of the indexes
+ *
+ * @param keys
+ * @param payloads
+ * @param n
+ * @param assig
+ * @param comp
+ */
+template <int PAYLOAD_BYTES>
+void stableSortSoA(int keys[], Payload<PAYLOAD_BYTES> payloads[], int n, Operation assig, Operation comp) {
+    vector<KeyPayload> permutation(n);
+    for (int i = 0; i < n; i++) {
+        permutation[i].key = keys[i];
+        permutation[i].payload = i;
+    }
+    assig.count(n);
+    powerSort(permutation.data(), n, assig, comp);
+    vector<Payload<PAYLOAD_BYTES> > sorted(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = permutation[i].key;
+        sorted[i] = payloads[permutation[i].payload];
+    }
+    copy(sorted.begin(), sorted.end(), payloads);
+    assig.count(3 * n);
+}
+
+/** Checks that the keys are in increasing order and that equal keys kept their original order
+ *
+ * @param keys
+ * @param indexes       Original position of each element
+ * @param n
+ * @return              true if the sort was stable
+ */
+bool isStablySorted(const int keys[], const int indexes[], int n) {
+    for (int i = 1; i < n; i++) {
+        if (keys[i] < keys[i - 1] || (keys[i] == keys[i - 1] && indexes[i] < indexes[i - 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <int PAYLOAD_BYTES>
+bool isStablySorted(const Record<PAYLOAD_BYTES> records[], int n) {
+    vector<int> keys(n), indexes(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = records[i].key;
+        indexes[i] = originalIndex(records[i].payload);
+    }
+    return isStablySorted(keys.data(), indexes.data(), n);
+}
+
+template <int PAYLOAD_BYTES>
+bool isStablySorted(const int keys[], const Payload<PAYLOAD_BYTES> payloads[], int n) {
+    vector<int> indexes(n);
+    for (int i = 0; i < n; i++) {
+        indexes[i] = originalIndex(payloads[i]);
+    }
+    return isStablySorted(keys, indexes.data(), n);
+}
+
+/** Sorts Key - Payload pairs made of keys[] and their original indexes with one of the direct sorts
+ *
+ * @param sort          bubbleSort, selectionSort or insertionSort
+ * @param keys
+ * @param n
+ * @return              true if the sort kept equal keys in their original order
+ */
+bool sortsStably(void (*sort)(KeyPayload[], int), const int keys[], int n) {
+    vector<KeyPayload> pairs(n);
+    for (int i = 0; i < n; i++) {
+        pairs[i].key = keys[i];
+        pairs[i].payload = i;
+    }
+    sort(pairs.data(), n);
+    vector<int> sortedKeys(n), indexes(n);
+    for (int i = 0; i < n; i++) {
+        sortedKeys[i] = pairs[i].key;
+        indexes[i] = pairs[i].payload;
+    }
+    return isStablySorted(sortedKeys.data(), indexes.data(), n);
+}
+
+/** Maps a key to an unsigned integer with the same order, the radix sorts work on its digits
+ */
+inline unsigned long long radixKey(int x) {
+    return (unsigned int) x ^ 0x80000000u;
+}
+
+inline unsigned long long radixKey(unsigned long long x) {
+    return x;
+}
+
+inline unsigned long long radixKey(const KeyPayload &x) {
+    return radixKey(x.key);
+}
+
+template <typename T>
+inline int radixKeyBits() {
+    return 64;
+}
+
+template <>
+inline int radixKeyBits<int>() {
+    return 32;
+}
+
+template <>
+inline int radixKeyBits<KeyPayload>() {
+    return 32;
+}
+
+/** Sorts array[low..high-1] by radixKey, used for the small buckets of the MSD Radix Sort
+ */
+template <typename T>
+void insertionSortByKey(T array[], int low, int high, Operation assig, Operation comp) {
+    for (int i = low + 1; i < high; i++) {
+        T temp = array[i];
+        int j = i - 1;
+        assig.count(2);
+        while (j >= low && radixKey(array[j]) > radixKey(temp)) {
+            comp.count();
+            assig.count(2);
+            array[j + 1] = array[j];
+            j--;
+        }
+        comp.count();
+        assig.count();
+        array[j + 1] = temp;
+    }
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: LSD Radix Sort, stable
+ *  The histograms of all digits are counted in one pass over the array, the digits on which every key is the same
+ *   are skipped ( for keys in [100, 10000] only 2 of the 4 bytes are looked at )
+ *
+ * @param array         int, unsigned long long or KeyPayload
+ * @param arraySize
+ * @param digitBits     8, 11 or 16
+ * @param assig
+ */
+template <typename T>
+void lsdRadixSort(T array[], int arraySize, int digitBits, Operation assig) {
+    if (arraySize < 2) {
+        return;
+    }
+    int keyBits = radixKeyBits<T>();
+    int nrDigits = (keyBits + digitBits - 1) / digitBits;
+    int nrBuckets = 1 << digitBits;
+    unsigned long long mask = nrBuckets - 1;
+    vector<vector<int> > count(nrDigits, vector<int>(nrBuckets + 1, 0));
+    for (int i = 0; i < arraySize; i++) {
+        unsigned long long key = radixKey(array[i]);
+        for (int d = 0; d < nrDigits; d++) {
+            count[d][(key >> (d * digitBits) & mask) + 1]++;
+        }
+    }
+    assig.count(nrDigits * arraySize);
+    vector<T> buffer(arraySize);
+    T *from = array, *to = buffer.data();
+    for (int d = 0; d < nrDigits; d++) {
+        int shift = d * digitBits;
+        if (count[d][(radixKey(from[0]) >> shift & mask) + 1] == arraySize) {
+            continue;
+        }
+        for (int b = 0; b < nrBuckets; b++) {
+            count[d][b + 1] += count[d][b];
+        }
+        for (int i = 0; i < arraySize; i++) {
+            to[count[d][radixKey(from[i]) >> shift & mask]++] = from[i];
+        }
+        assig.count(arraySize);
+        swap(from, to);
+    }
+    if (from != array) {
+        copy(from, from + arraySize, array);
+        assig.count(arraySize);
+    }
+}
+
+/** Sorts array[low..high-1] in increasing order, in-place
+ *  Method implemented: MSD Radix Sort ( American Flag Sort ) on 8 bit digits, not stable
+ *  Each bucket is permuted into place by following swap cycles, then sorted recursively by the next digit
+ *
+ * @param array         int, unsigned long long or KeyPayload
+ * @param low           First index
+ * @param high          Last index ( exclusive )
+ * @param shift         Position of the current digit, radixKeyBits<T>() - 8 at the first call
+ * @param assig
+ * @param comp
+ */
+template <typename T>
+void americanFlagSort(T array[], int low, int high, int shift, Operation assig, Operation comp) {
+    if (high - low <= INSERTION_CUTOFF) {
+        insertionSortByKey(array, low, high, assig, comp);
+        return;
+    }
+    int count[256];
+    int head[256];
+    int tail[256];
+    do {
+        fill(count, count + 256, 0);
+        for (int i = low; i < high; i++) {
+            count[radixKey(array[i]) >> shift & 0xFF]++;
+        }
+        assig.count(high - low);
+        if (count[radixKey(array[low]) >> shift & 0xFF] != high - low) {
+            break;
+        }
+        shift -= 8;
+    } while (shift >= 0);
+    if (shift < 0) {
+        return;
+    }
+    head[0] = low;
+    for (int b = 0; b < 256; b++) {
+        tail[b] = head[b] + count[b];
+        if (b < 255) {
+            head[b + 1] = tail[b];
+        }
+    }
+    for (int b = 0; b < 256; b++) {
+        while (head[b] < tail[b]) {
+            T value = array[head[b]];
+            int digit = (int) (radixKey(value) >> shift & 0xFF);
+            while (digit != b) {
+                swap(value, array[head[digit]++]);
+                assig.count(3);
+                digit = (int) (radixKey(value) >> shift & 0xFF);
+            }
+            array[head[b]++] = value;
+            assig.count();
+        }
+    }
+    if (shift == 0) {
+        return;
+    }
+    int start = low;
+    for (int b = 0; b < 256; b++) {
+        if (count[b] > 1) {
+            americanFlagSort(array, start, start + count[b], shift - 8, assig, comp);
+        }
+        start += count[b];
+    }
+}
+
+template <typename T>
+void americanFlagSort(T array[], int arraySize, Operation assig, Operation comp) {
+    americanFlagSort(array, 0, arraySize, radixKeyBits<T>() - 8, assig, comp);
+}
+
+typedef struct {
+    int runs;
+    long long inversions;
+    int distinct;
+    int minimum;
+    int maximum;
+} Presortedness;
+
+enum SortChoice {
+    INSERTION_CHOICE = 0, MERGE_CHOICE, QUICK_CHOICE, RADIX_CHOICE
+};
+
+const char *sortChoiceNames[] = {"Insertion Sort", "Natural Merge Sort", "Quick Sort", "Radix Sort"};
+
+/** Estimates how sorted an array already is, in a single pass + INVERSION_SAMPLES random pairs
+ *
+ * @param array
+ * @param arraySize
+ * @param comp          Operation counting comparisons
+ * @return              Runs, estimated inversions, estimated distinct keys and the key range
+ */
+Presortedness analyzePresortedness(int array[], int arraySize, Operation comp) {
+    Presortedness result = {0, 0, 0, 0, 0};
+    if (arraySize == 0) {
+        return result;
+    }
+    unsigned long long bitmap[DISTINCT_BITMAP_SIZE / 64] = {0};
+    result.runs = 1;
+    result.minimum = result.maximum = array[0];
+    int direction = 0;
+    for (int i = 0; i < arraySize; i++) {
+        unsigned int bit = ((unsigned int) array[i] * 2654435761u) >> 20 & (DISTINCT_BITMAP_SIZE - 1);
+        bitmap[bit >> 6] |= 1ULL << (bit & 63);
+        result.minimum = min(result.minimum, array[i]);
+        result.maximum = max(result.maximum, array[i]);
+        if (i == 0) {
+            continue;
+        }
+        comp.count();
+        int step = array[i] < array[i - 1] ? -1 : 1;
+        if (direction == 0) {
+            direction = step;
+        } else if (step != direction) {
+            result.runs++;
+            direction = 0;
+        }
+    }
+
+    int zeros = 0;
+    for (int w = 0; w < DISTINCT_BITMAP_SIZE / 64; w++) {
+        zeros += 64 - (int) bitset<64>(bitmap[w]).count();
+    }
+    double distinct = zeros ? -DISTINCT_BITMAP_SIZE * log((double) zeros / DISTINCT_BITMAP_SIZE) : arraySize;
+    result.distinct = (int) min(distinct + 0.5, (double) arraySize);
+
+    if (arraySize > 1) {
+        int inverted = 0;
+        for (int s = 0; s < INVERSION_SAMPLES; s++) {
+            int i = rand() % arraySize;
+            int j = rand() % arraySize;
+            if (i == j) {
+                continue;
+            }
+            comp.count();
+            if ((i < j && array[i] > array[j]) || (j < i && array[j] > array[i])) {
+                inverted++;
+            }
+        }
+        double pairs = (double) arraySize * (arraySize - 1) / 2;
+        result.inversions = (long long) ((inverted + 0.5) / (INVERSION_SAMPLES + 1) * pairs);
+    }
+    return result;
+}
+
+/** Chooses the cheapest algorithm for the given presortedness, using the estimated number of operations
+ */
+SortChoice chooseSort(const Presortedness &info, int arraySize) {
+    double n = arraySize;
+    double costs[4];
+    costs[INSERTION_CHOICE] = n + info.inversions;
+    costs[MERGE_CHOICE] = n + (info.runs > 1 ? 2 * n * ceil(log2((double) info.runs)) : 0);
+    costs[QUICK_CHOICE] = 2 * n * log2(max(2, info.distinct)) + n;
+    int digits = 0;
+    for (unsigned int range = (unsigned int) info.maximum - (unsigned int) info.minimum; range; range >>= 8) {
+        digits++;
+    }
+    costs[RADIX_CHOICE] = 3 * n * digits + 2 * n;
+    int best = INSERTION_CHOICE;
+    for (int c = 1; c < 4; c++) {
+        if (costs[c] < costs[best]) {
+            best = c;
+        }
+    }
+    return (SortChoice) best;
+}
+
+/** Sorts a given algorithm in increasing order
+ *  Method implemented: Adaptive Sort, analyzes the array and dispatches to the cheapest algorithm
+ *
+ * @param array
+ * @param arraySize
+ * @return              The algorithm that was chosen
+ */
+SortChoice adaptiveSort(int array[], int arraySize) {
+    Operation assig = profiler.createOperation("Adp_Sort_Assig", arraySize);
+    Operation comp = profiler.createOperation("Adp_Sort_Comp", arraySize);
+    Presortedness info = analyzePresortedness(array, arraySize, comp);
+    SortChoice choice = chooseSort(info, arraySize);
+    switch (choice) {
+        case INSERTION_CHOICE:
+            insertionSortRange(array, 0, arraySize - 1, assig, comp);
+            break;
+        case MERGE_CHOICE:
+            naturalMergeSort(array, arraySize, assig, comp);
+            break;
+        case QUICK_CHOICE:
+            quickSort3Way(array, 0, arraySize - 1, assig, comp);
+            break;
+        case RADIX_CHOICE:
+            lsdRadixSort(array, arraySize, 8, assig);
+            break;
+    }
+    return choice;
+}
+
+/** Runs Shell Sort with every gap sequence on a copy of the given array
+ *
+ * @param mainArray
+ * @param n
+ */
+void runShellSortTests(int mainArray[], int n) {
+    int a[MAX_SIZE];
+    for (int sequence = 0; sequence < NR_GAP_SEQUENCES; sequence++) {
+        copyArray(mainArray, a, n);
+        shellSort(a, n, (GapSequence) sequence);
+        profiler.addSeries(shellSortTotal[sequence], shellSortAssig[sequence], shellSortComp[sequence]);
+    }
+}
+
+/** Runs the Adaptive Sort and, for reference, the algorithms it can dispatch to on a copy of the given array
+ *  ( Insertion Sort is already measured by runTests )
+ *
+ * @param mainArray
+ * @param n
+ */
+void runAdaptiveSortTests(int mainArray[], int n) {
+    int a[MAX_SIZE];
+    copyArray(mainArray, a, n);
+    naturalMergeSort(a, n, profiler.createOperation("Mrg_Sort_Assig", n), profiler.createOperation("Mrg_Sort_Comp", n));
+    copyArray(mainArray, a, n);
+    quickSort3Way(a, 0, n - 1, profiler.createOperation("Qck_Sort_Assig", n), profiler.createOperation("Qck_Sort_Comp", n));
+    copyArray(mainArray, a, n);
+    profiler.createOperation("Rdx_Sort_Comp", n);
+    lsdRadixSort(a, n, 8, profiler.createOperation("Rdx_Sort_Assig", n));
+    copyArray(mainArray, a, n);
+    adaptiveSort(a, n);
+    profiler.addSeries("Merge_Sort", "Mrg_Sort_Assig", "Mrg_Sort_Comp");
+    profiler.addSeries("Quick_Sort", "Qck_Sort_Assig", "Qck_Sort_Comp");
+    profiler.addSeries("Radix_Sort", "Rdx_Sort_Assig", "Rdx_Sort_Comp");
+    profiler.addSeries("Adaptive_Sort", "Adp_Sort_Assig", "Adp_Sort_Comp");
+}
+
+/** Widens an int key to 64 bits without changing the order, the key is copied to the upper bits too, so the
+ *  radix sorts can't skip the high digits
+ */
+inline unsigned long long wideKey(int x) {
+    return ((unsigned long long) x << 40) + (unsigned int) x;
+}
+
+/** Runs the LSD Radix Sort with 11 and 16 bit digits and the MSD Radix Sort on a copy of the given array, then the
+ *  8 bit LSD and the MSD Radix Sort on the same keys widened to 64 bits
+ *  ( the 8 bit LSD Radix Sort on int keys is measured by runAdaptiveSortTests )
+ *
+ * @param mainArray
+ * @param n
+ */
+void runRadixSortTests(int mainArray[], int n) {
+    int a[MAX_SIZE];
+    unsigned long long wide[MAX_SIZE];
+    copyArray(mainArray, a, n);
+    profiler.createOperation("Rdx11_Sort_Comp", n);
+    lsdRadixSort(a, n, 11, profiler.createOperation("Rdx11_Sort_Assig", n));
+    copyArray(mainArray, a, n);
+    profiler.createOperation("Rdx16_Sort_Comp", n);
+    lsdRadixSort(a, n, 16, profiler.createOperation("Rdx16_Sort_Assig", n));
+    copyArray(mainArray, a, n);
+    americanFlagSort(a, n, profiler.createOperation("Msd_Sort_Assig", n), profiler.createOperation("Msd_Sort_Comp", n));
+    for (int i = 0; i < n; i++) {
+        wide[i] = wideKey(mainArray[i]);
+    }
+    profiler.createOperation("Rdx64_Sort_Comp", n);
+    lsdRadixSort(wide, n, 8, profiler.createOperation("Rdx64_Sort_Assig", n));
+    for (int i = 0; i < n; i++) {
+        wide[i] = wideKey(mainArray[i]);
+    }
+    americanFlagSort(wide, n, profiler.createOperation("Msd64_Sort_Assig", n),
+                     profiler.createOperation("Msd64_Sort_Comp", n));
+    profiler.addSeries("Radix_Sort_11", "Rdx11_Sort_Assig", "Rdx11_Sort_Comp");
+    profiler.addSeries("Radix_Sort_16", "Rdx16_Sort_Assig", "Rdx16_Sort_Comp");
+    profiler.addSeries("American_Flag_Sort", "Msd_Sort_Assig", "Msd_Sort_Comp");
+    profiler.addSeries("Radix_Sort_64", "Rdx64_Sort_Assig", "Rdx64_Sort_Comp");
+    profiler.addSeries("American_Flag_Sort_64", "Msd64_Sort_Assig", "Msd64_Sort_Comp");
+}
+
+/** Sorts arrays of n elements made of 1, 2, 4, ... n / 2 sorted runs, to show that Power Sort is O(n*log r)
+ *  The x axis of the charts is the number of runs
+ */
+void runsCase(int n) {
+    int mainArray[MAX_SIZE];
+    int a[MAX_SIZE];
+    for (int nrRuns = 1; nrRuns <= n / 2; nrRuns *= 2) {
+        fillRuns(mainArray, n, nrRuns);
+        copyArray(mainArray, a, n);
+        Operation powerSortOp = profiler.createOperation("Power_Sort_Runs", nrRuns);
+        powerSort(a, n, powerSortOp, powerSortOp);
+        copyArray(mainArray, a, n);
+        Operation mergeSortOp = profiler.createOperation("Merge_Sort_Runs", nrRuns);
+        naturalMergeSort(a, n, mergeSortOp, mergeSortOp);
+        copyArray(mainArray, a, n);
+        Operation quickSortOp = profiler.createOperation("Quick_Sort_Runs", nrRuns);
+        quickSort3Way(a, 0, n - 1, quickSortOp, quickSortOp);
+    }
+    profiler.createGroup("Runs_Total", "Power_Sort_Runs", "Merge_Sort_Runs", "Quick_Sort_Runs");
+}
+
+/** Measures the running time ( microseconds, sum of 5 runs ) of the AoS and SoA stable sorts with the given payload
+ *  size on n records, the keys are random, so there are a lot of equal keys
+ */
+template <int PAYLOAD_BYTES>
+void layoutCase(int n, const char *aosName, const char *soaName) {
+    int mainArray[MAX_SIZE];
+    Profiler local;
+    Operation dummy = local.createOperation("Dummy", 0);
+    vector<Record<PAYLOAD_BYTES> > records(n);
+    vector<int> keys(n);
+    vector<Payload<PAYLOAD_BYTES> > payloads(n);
+    for (int run = 0; run < 5; run++) {
+        FillRandomArray(mainArray, n, 100, 10000, false, 0);
+        for (int i = 0; i < n; i++) {
+            records[i].key = keys[i] = mainArray[i];
+            makePayload(records[i].payload, i);
+            makePayload(payloads[i], i);
+        }
+        auto start = chrono::steady_clock::now();
+        stableSortAoS(records.data(), n, dummy, dummy);
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation(aosName, n).count((int) elapsed.count());
+
+        start = chrono::steady_clock::now();
+        stableSortSoA(keys.data(), payloads.data(), n, dummy, dummy);
+        elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation(soaName, n).count((int) elapsed.count());
+
+        if (!isStablySorted(records.data(), n) || !isStablySorted(keys.data(), payloads.data(), n)) {
+            cout << "Stability broken at n = " << n << endl;
+        }
+    }
+}
+
+void runLayoutTests(int n) {
+    layoutCase<8>(n, "AoS_8_Bytes", "SoA_8_Bytes");
+    layoutCase<32>(n, "AoS_32_Bytes", "SoA_32_Bytes");
+    layoutCase<128>(n, "AoS_128_Bytes", "SoA_128_Bytes");
+    profiler.createGroup("Layout_8_Bytes", "AoS_8_Bytes", "SoA_8_Bytes");
+    profiler.createGroup("Layout_32_Bytes", "AoS_32_Bytes", "SoA_32_Bytes");
+    profiler.createGroup("Layout_128_Bytes", "AoS_128_Bytes", "SoA_128_Bytes");
+}
+
+/** Measures the branch misses and the running time ( microseconds ) of a kernel on a copy of the given array
+ */
+void measureKernel(void (*kernel)(int[], int), int mainArray[], int n, BranchMissCounter &counter,
+                   const char *missesName, const char *timeName) {
+    int a[MAX_SIZE];
+    copyArray(mainArray, a, n);
+    auto start = chrono::steady_clock::now();
+    counter.start();
+    kernel(a, n);
+    long long misses = counter.stop();
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+    profiler.createOperation(missesName, n).count((int) misses);
+    profiler.createOperation(timeName, n).count((int) elapsed.count());
+}
+
+void runBranchTests(int n, BranchMissCounter &counter) {
+    int mainArray[MAX_SIZE];
+    FillRandomArray(mainArray, n, 100, 10000, false, 0);
+    measureKernel(selectionSortBranchy, mainArray, n, counter, "Sel_Branchy_Misses", "Sel_Branchy_Time");
+    measureKernel(selectionSortBranchless, mainArray, n, counter, "Sel_Branchless_Misses", "Sel_Branchless_Time");
+    measureKernel(selectionSortVectorized, mainArray, n, counter, "Sel_Vectorized_Misses", "Sel_Vectorized_Time");
+    measureKernel(insertionSortBranchy, mainArray, n, counter, "Ins_Branchy_Misses", "Ins_Branchy_Time");
+    measureKernel(insertionSortBranchless, mainArray, n, counter, "Ins_Branchless_Misses", "Ins_Branchless_Time");
+    profiler.createGroup("Branch_Misses", "Sel_Branchy_Misses", "Sel_Branchless_Misses", "Sel_Vectorized_Misses",
+                         "Ins_Branchy_Misses", "Ins_Branchless_Misses");
+    profiler.createGroup("Branch_Kernels_Time", "Sel_Branchy_Time", "Sel_Branchless_Time", "Sel_Vectorized_Time",
+                         "Ins_Branchy_Time", "Ins_Branchless_Time");
+}
+
+void runTests(int mainArray[], int n, int sorted) {
+    int a[MAX_SIZE];
+    int b[MAX_SIZE];
+    int c[MAX_SIZE];
+    int d[MAX_SIZE];
+    int e[MAX_SIZE];
+    copyArray(mainArray, a, n);
+    copyArray(mainArray, b, n);
+    copyArray(mainArray, c, n);
+    copyArray(mainArray, d, n);
+    copyArray(mainArray, e, n);
     insertionSort(a, n);
     bubbleSort(b, n);
     selectionSort(c, n);
+    networkSort(d, n);
+    powerSort(e, n, profiler.createOperation("Pwr_Sort_Assig", n), profiler.createOperation("Pwr_Sort_Comp", n));
+    runShellSortTests(mainArray, n);
+    runAdaptiveSortTests(mainArray, n);
+    runRadixSortTests(mainArray, n);
     profiler.addSeries("Selection_Sort", "Sel_Sort_Assig", "Sel_Sort_Comp");
     profiler.addSeries("Insertion_Sort", "Ins_Sort_Assig", "Ins_Sort_Comp");
     profiler.addSeries("Bubble_Sort", "Bub_Sort_Assig", "Bub_Sort_Comp");
+    profiler.addSeries("Network_Sort", "Net_Sort_Assig", "Net_Sort_Comp");
+    profiler.addSeries("Power_Sort", "Pwr_Sort_Assig", "Pwr_Sort_Comp");
     if (sorted == 1) {
-        profiler.createGroup("Assignments_Best", "Sel_Sort_Assig", "Ins_Sort_Assig", "Bub_Sort_Assig");
-        profiler.createGroup("Comparisons_Best", "Sel_Sort_Comp", "Ins_Sort_Comp", "Bub_Sort_Comp");
-        profiler.createGroup("Best_Case_Total", "Selection_Sort", "Insertion_Sort", "Bubble_Sort");
+        profiler.createGroup("Assignments_Best", "Sel_Sort_Assig", "Ins_Sort_Assig", "Bub_Sort_Assig", "Net_Sort_Assig",
+                             "Shl_Ciura_Assig", "Adp_Sort_Assig", "Pwr_Sort_Assig");
+        profiler.createGroup("Comparisons_Best", "Sel_Sort_Comp", "Ins_Sort_Comp", "Bub_Sort_Comp", "Net_Sort_Comp",
+                             "Shl_Ciura_Comp", "Adp_Sort_Comp", "Pwr_Sort_Comp");
+        profiler.createGroup("Best_Case_Total", "Selection_Sort", "Insertion_Sort", "Bubble_Sort", "Network_Sort",
+                             "Shell_Sort_Ciura", "Adaptive_Sort", "Power_Sort");
+        profiler.createGroup("Shell_Gaps_Best", "Shell_Sort_Shell", "Shell_Sort_Knuth", "Shell_Sort_Sedgewick",
+                             "Shell_Sort_Ciura", "Shell_Sort_Tokuda");
+        profiler.createGroup("Adaptive_Gain_Best", "Adaptive_Sort", "Insertion_Sort", "Merge_Sort", "Quick_Sort",
+                             "Radix_Sort");
+        profiler.createGroup("Radix_vs_Comparison_Best", "Radix_Sort", "Radix_Sort_11", "Radix_Sort_16",
+                             "American_Flag_Sort", "Radix_Sort_64", "American_Flag_Sort_64", "Quick_Sort",
+                             "Merge_Sort", "Shell_Sort_Ciura");
     } else if (sorted == 2) {
-        profiler.createGroup("Assignments_Worst", "Sel_Sort_Assig", "Ins_Sort_Assig", "Bub_Sort_Assig");
-        profiler.createGroup("Comparisons_Worst", "Sel_Sort_Comp", "Ins_Sort_Comp", "Bub_Sort_Comp");
-        profiler.createGroup("Worst_Case_Total", "Selection_Sort", "Insertion_Sort", "Bubble_Sort");
+        profiler.createGroup("Assignments_Worst", "Sel_Sort_Assig", "Ins_Sort_Assig", "Bub_Sort_Assig", "Net_Sort_Assig",
+                             "Shl_Ciura_Assig", "Adp_Sort_Assig", "Pwr_Sort_Assig");
+        profiler.createGroup("Comparisons_Worst", "Sel_Sort_Comp", "Ins_Sort_Comp", "Bub_Sort_Comp", "Net_Sort_Comp",
+                             "Shl_Ciura_Comp", "Adp_Sort_Comp", "Pwr_Sort_Comp");
+        profiler.createGroup("Worst_Case_Total", "Selection_Sort", "Insertion_Sort", "Bubble_Sort", "Network_Sort",
+                             "Shell_Sort_Ciura", "Adaptive_Sort", "Power_Sort");
+        profiler.createGroup("Shell_Gaps_Worst", "Shell_Sort_Shell", "Shell_Sort_Knuth", "Shell_Sort_Sedgewick",
+                             "Shell_Sort_Ciura", "Shell_Sort_Tokuda");
+        profiler.createGroup("Adaptive_Gain_Worst", "Adaptive_Sort", "Insertion_Sort", "Merge_Sort", "Quick_Sort",
+                             "Radix_Sort");
+        profiler.createGroup("Radix_vs_Comparison_Worst", "Radix_Sort", "Radix_Sort_11", "Radix_Sort_16",
+                             "American_Flag_Sort", "Radix_Sort_64", "American_Flag_Sort_64", "Quick_Sort",
+                             "Merge_Sort", "Shell_Sort_Ciura");
     } else {
-        profiler.createGroup("Assignments_Avg", "Sel_Sort_Assig", "Ins_Sort_Assig", "Bub_Sort_Assig");
-        profiler.createGroup("Comparisons_Avg", "Sel_Sort_Comp", "Ins_Sort_Comp", "Bub_Sort_Comp");
-        profiler.createGroup("Avg_Case_Total", "Selection_Sort", "Insertion_Sort", "Bubble_Sort");
+        profiler.createGroup("Assignments_Avg", "Sel_Sort_Assig", "Ins_Sort_Assig", "Bub_Sort_Assig", "Net_Sort_Assig",
+                             "Shl_Ciura_Assig", "Adp_Sort_Assig", "Pwr_Sort_Assig");
+        profiler.createGroup("Comparisons_Avg", "Sel_Sort_Comp", "Ins_Sort_Comp", "Bub_Sort_Comp", "Net_Sort_Comp",
+                             "Shl_Ciura_Comp", "Adp_Sort_Comp", "Pwr_Sort_Comp");
+        profiler.createGroup("Avg_Case_Total", "Selection_Sort", "Insertion_Sort", "Bubble_Sort", "Network_Sort",
+                             "Shell_Sort_Ciura", "Adaptive_Sort", "Power_Sort");
+        profiler.createGroup("Shell_Gaps_Avg", "Shell_Sort_Shell", "Shell_Sort_Knuth", "Shell_Sort_Sedgewick",
+                             "Shell_Sort_Ciura", "Shell_Sort_Tokuda");
+        profiler.createGroup("Adaptive_Gain_Avg", "Adaptive_Sort", "Insertion_Sort", "Merge_Sort", "Quick_Sort",
+                             "Radix_Sort");
+        profiler.createGroup("Radix_vs_Comparison_Avg", "Radix_Sort", "Radix_Sort_11", "Radix_Sort_16",
+                             "American_Flag_Sort", "Radix_Sort_64", "American_Flag_Sort_64", "Quick_Sort",
+                             "Merge_Sort", "Shell_Sort_Ciura");
     }
 
 
@@ -190,37 +1833,19 @@ void runTests(int a[], int b[], int c[], int n, int sorted) {
 void bestCase(int n) {
     int mainArray[MAX_SIZE];
     FillRandomArray(mainArray, n, 100, 10000, false, 1);
-    int a[MAX_SIZE];
-    int b[MAX_SIZE];
-    int c[MAX_SIZE];
-    copyArray(mainArray, a, MAX_SIZE);
-    copyArray(mainArray, b, MAX_SIZE);
-    copyArray(mainArray, c, MAX_SIZE);
-    runTests(a, b, c, n, 1);
+    runTests(mainArray, n, 1);
 };
 
 void worstCase(int n) {
     int mainArray[MAX_SIZE];
     FillRandomArray(mainArray, n, 100, 10000, false, 2);
-    int a[MAX_SIZE];
-    int b[MAX_SIZE];
-    int c[MAX_SIZE];
-    copyArray(mainArray, a, MAX_SIZE);
-    copyArray(mainArray, b, MAX_SIZE);
-    copyArray(mainArray, c, MAX_SIZE);
-    runTests(a, b, c, n, 2);
+    runTests(mainArray, n, 2);
 };
 
 void averageCase(int n) {
     int mainArray[MAX_SIZE];
     FillRandomArray(mainArray, n, 100, 10000, false, 0);
-    int a[MAX_SIZE];
-    int b[MAX_SIZE];
-    int c[MAX_SIZE];
-    copyArray(mainArray, a, MAX_SIZE);
-    copyArray(mainArray, b, MAX_SIZE);
-    copyArray(mainArray, c, MAX_SIZE);
-    runTests(a, b, c, n, 0);
+    runTests(mainArray, n, 0);
 };
 
 void exemplifyCorrectness(int n) {
@@ -229,9 +1854,13 @@ void exemplifyCorrectness(int n) {
     int a[MAX_SIZE];
     int b[MAX_SIZE];
     int c[MAX_SIZE];
+    int d[MAX_SIZE];
+    int e[MAX_SIZE];
     copyArray(testArray, a, MAX_SIZE);
     copyArray(testArray, b, MAX_SIZE);
     copyArray(testArray, c, MAX_SIZE);
+    copyArray(testArray, d, MAX_SIZE);
+    copyArray(testArray, e, MAX_SIZE);
 
     cout << "Insertion Sort:" << endl;
     printArray(a, n);
@@ -248,6 +1877,124 @@ void exemplifyCorrectness(int n) {
     selectionSort(c, n);
     printArray(c, n);
 
+    cout << endl << "Network Sort:" << endl;
+    printArray(d, n);
+    networkSort(d, n);
+    printArray(d, n);
+
+    cout << endl << "Shell Sort ( Ciura gaps ):" << endl;
+    printArray(e, n);
+    shellSort(e, n, CIURA_GAPS);
+    printArray(e, n);
+
+    copyArray(testArray, e, n);
+    cout << endl << "Selection Sort ( vectorized argmin ):" << endl;
+    printArray(e, n);
+    selectionSortVectorized(e, n);
+    printArray(e, n);
+
+    copyArray(testArray, e, n);
+    cout << endl << "Insertion Sort ( branchless binary search ):" << endl;
+    printArray(e, n);
+    insertionSortBranchless(e, n);
+    printArray(e, n);
+
+    copyArray(testArray, e, n);
+    cout << endl << "Power Sort:" << endl;
+    printArray(e, n);
+    powerSort(e, n, profiler.createOperation("Dummy", 0), profiler.createOperation("Dummy", 0));
+    printArray(e, n);
+
+    copyArray(testArray, e, n);
+    Presortedness info = analyzePresortedness(e, n, profiler.createOperation("Dummy", 0));
+    cout << endl << "Adaptive Sort ( runs: " << info.runs << ", inversions: ~" << info.inversions << ", distinct: ~"
+         << info.distinct << " ):" << endl;
+    printArray(e, n);
+    SortChoice choice = adaptiveSort(e, n);
+    printArray(e, n);
+    cout << "Dispatched to " << sortChoiceNames[choice] << endl;
+
+    KeyPayload pairs[MAX_SIZE];
+    int keys[MAX_SIZE] = {};
+    int indexes[MAX_SIZE] = {};
+    for (int i = 0; i < n; i++) {
+        pairs[i].key = testArray[i] / 10;
+        pairs[i].payload = i;
+    }
+    cout << endl << "LSD Radix Sort on Key - Payload pairs ( key:payload ):" << endl;
+    lsdRadixSort(pairs, n, 8, profiler.createOperation("Dummy", 0));
+    for (int i = 0; i < n; i++) {
+        cout << pairs[i].key << ":" << pairs[i].payload << " ";
+        keys[i] = pairs[i].key;
+        indexes[i] = pairs[i].payload;
+    }
+    cout << endl << (isStablySorted(keys, indexes, n) ? "Stable" : "NOT stable") << endl;
+
+    Record<32> records[MAX_SIZE];
+    for (int i = 0; i < n; i++) {
+        records[i].key = testArray[i] / 10;
+        makePayload(records[i].payload, i);
+    }
+    cout << endl << "Stable Key - Payload Sort, Array-of-Structs ( key:original index ):" << endl;
+    stableSortAoS(records, n, profiler.createOperation("Dummy", 0), profiler.createOperation("Dummy", 0));
+    for (int i = 0; i < n; i++) {
+        cout << records[i].key << ":" << originalIndex(records[i].payload) << " ";
+    }
+    cout << endl << (isStablySorted(records, n) ? "Stable" : "NOT stable") << endl;
+
+    for (int i = 0; i < n; i++) {
+        pairs[i].key = testArray[i] / 10;
+        pairs[i].payload = i;
+    }
+    americanFlagSort(pairs, n, profiler.createOperation("Dummy", 0), profiler.createOperation("Dummy", 0));
+    for (int i = 0; i < n; i++) {
+        keys[i] = pairs[i].key;
+        indexes[i] = pairs[i].payload;
+    }
+    cout << endl << "American Flag Sort on the same pairs: " << (isStablySorted(keys, indexes, n) ? "Stable" : "NOT stable")
+         << endl;
+
+    int tiedKeys[MAX_SIZE];
+    for (int i = 0; i < n; i++) {
+        tiedKeys[i] = testArray[i] / 10;
+    }
+    const int selectionCounterexample[] = {2, 2, 1};
+    cout << endl << "Direct Sorts on the same pairs:" << endl;
+    cout << "Bubble Sort: " << (sortsStably(bubbleSort<KeyPayload>, tiedKeys, n) ? "Stable" : "NOT stable") << endl;
+    cout << "Insertion Sort: " << (sortsStably(insertionSort<KeyPayload>, tiedKeys, n) ? "Stable" : "NOT stable")
+         << endl;
+    cout << "Selection Sort: " << (sortsStably(selectionSort<KeyPayload>, tiedKeys, n) ? "Stable" : "NOT stable")
+         << endl;
+    cout << "Selection Sort on 2a 2b 1: "
+         << (sortsStably(selectionSort<KeyPayload>, selectionCounterexample, 3) ? "Stable" : "NOT stable") << endl;
+
+    copyArray(testArray, e, n);
+    cout << endl << "MSD Radix Sort ( American Flag ):" << endl;
+    printArray(e, n);
+    americanFlagSort(e, n, profiler.createOperation("Dummy", 0), profiler.createOperation("Dummy", 0));
+    printArray(e, n);
+
+    unsigned long long wide[MAX_SIZE];
+    unsigned long long wideCopy[MAX_SIZE];
+    for (int i = 0; i < n; i++) {
+        wide[i] = wideKey(testArray[i]);
+    }
+    wide[0] = ULLONG_MAX;
+    wide[n - 1] = 0;
+    copy(wide, wide + n, wideCopy);
+    cout << endl << "LSD Radix Sort on 64 bit keys:" << endl;
+    printArray(wide, n);
+    lsdRadixSort(wide, n, 8, profiler.createOperation("Dummy", 0));
+    printArray(wide, n);
+    bool sorted = true;
+    for (int i = 1; i < n; i++) {
+        sorted = sorted && wide[i - 1] <= wide[i];
+    }
+    cout << (sorted ? "sorted" : "NOT sorted") << endl;
+    americanFlagSort(wideCopy, n, profiler.createOperation("Dummy", 0), profiler.createOperation("Dummy", 0));
+    cout << "American Flag Sort on the same keys: "
+         << (equal(wide, wide + n, wideCopy) ? "same order" : "DIFFERENT order") << endl;
+
 }
 
 int main() {
@@ -276,9 +2023,44 @@ int main() {
     profiler.divideValues("Sel_Sort_Comp", 5);
     profiler.divideValues("Ins_Sort_Comp", 5);
     profiler.divideValues("Bub_Sort_Comp", 5);
+    profiler.divideValues("Net_Sort_Assig", 5);
+    profiler.divideValues("Net_Sort_Comp", 5);
     profiler.divideValues("Selection_Sort", 5);
     profiler.divideValues("Insertion_Sort", 5);
     profiler.divideValues("Bubble_Sort", 5);
+    profiler.divideValues("Network_Sort", 5);
+    for (int sequence = 0; sequence < NR_GAP_SEQUENCES; sequence++) {
+        profiler.divideValues(shellSortAssig[sequence], 5);
+        profiler.divideValues(shellSortComp[sequence], 5);
+        profiler.divideValues(shellSortTotal[sequence], 5);
+    }
+    const char *averagedSeries[] = {"Mrg_Sort_Assig", "Mrg_Sort_Comp", "Merge_Sort", "Qck_Sort_Assig", "Qck_Sort_Comp",
+                                    "Quick_Sort", "Rdx_Sort_Assig", "Rdx_Sort_Comp", "Radix_Sort", "Adp_Sort_Assig",
+                                    "Adp_Sort_Comp", "Adaptive_Sort", "Rdx11_Sort_Assig", "Rdx11_Sort_Comp",
+                                    "Radix_Sort_11", "Rdx16_Sort_Assig", "Rdx16_Sort_Comp", "Radix_Sort_16",
+                                    "Msd_Sort_Assig", "Msd_Sort_Comp", "American_Flag_Sort", "Rdx64_Sort_Assig",
+                                    "Rdx64_Sort_Comp", "Radix_Sort_64", "Msd64_Sort_Assig", "Msd64_Sort_Comp",
+                                    "American_Flag_Sort_64", "Pwr_Sort_Assig", "Pwr_Sort_Comp", "Power_Sort"};
+    for (const char *series : averagedSeries) {
+        profiler.divideValues(series, 5);
+    }
+    profiler.showReport();
+    profiler.reset("Direct_Sorting_Method_Comparisons_Runs");
+    runsCase(MAX_SIZE);
+    profiler.showReport();
+    profiler.reset("Direct_Sorting_Method_Comparisons_Layouts");
+    for (int i = 100; i <= 10000; i += 500) {
+        runLayoutTests(i);
+    }
+    profiler.showReport();
+    profiler.reset("Direct_Sorting_Method_Comparisons_Branches");
+    BranchMissCounter counter;
+    if (!counter.available()) {
+        cout << "Hardware branch miss counters are not available, only the running times are measured" << endl;
+    }
+    for (int i = 100; i <= 10000; i += 500) {
+        runBranchTests(i, counter);
+    }
     profiler.showReport();
     return 0;
 }
\ No newline at end of file
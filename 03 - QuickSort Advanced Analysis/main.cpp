@@ -29,6 +29,17 @@
  *               be done. In addition the best case is also hard to be implemented, my conclusion is that it should be only
  *               used when we have an unsorted array ( In the average case ).
  *
+ *      *Iterative Quick-Sort*
+ *          Algorithm:
+ *              The recursive Quick-Sort goes as deep as the number of partitions in a chain, n levels on the worst case
+ *               input, which overflows a small thread stack long before the quadratic time becomes a problem.
+ *               quickSortIterative keeps the larger part on an explicit stack of QUICK_SORT_STACK_SIZE parts and
+ *               continues with the smaller one, so the stack holds at most log2(n) parts, on the worst case only one.
+ *          Run Time:
+ *              Same partitions, so the same number of operations ( "Worst Case Iterative" chart ). The "Iterative
+ *               Quick Sort Time" chart compares the two with the median of three up to ITERATIVE_MAX_SIZE elements,
+ *               the iterative one is as fast as the recursive one, within the noise of the measurement.
+ *
  *      *Heap-Sort and Quick-Sort comparison in the average case*
  *          According to charts:
  *              In the average case, we can see, that the Quick-Sort algorithm does the job faster with less
@@ -39,26 +50,583 @@
  *               performance difference between the two.
  *          Conclusion:
  *              Use Quick-Sort if we don't much about our array, otherwise consider other algorithms.
+ *          Floyd's bottom-up Heap-Sort:
+ *              Part of the difference above came from the Heap-Sort itself: the first version swapped on every level
+ *               ( three assignments and a recursive call ), now siftDown carries the element as a hole and writes it
+ *               once, but it still does two comparisons per level. The element which is sifted down after an extraction
+ *               comes from the bottom of the heap, so it almost always goes back to the bottom. bottomUpHeapSort moves
+ *               the hole down along the larger children to a leaf with one comparison per level, and only then looks
+ *               for the place of the element, going up from the leaf, the elements are moved into the hole, not
+ *               swapped.
+ *              Redone comparison ( "Average Case" chart ): for n = 10000 the bottom-up Heap-Sort does about 320
+ *               thousand operations, Heap-Sort with siftDown 410 thousand ( 700 thousand with the swapping version ) and
+ *               Quick-Sort 410 to 500 thousand, so counted in operations Heap-Sort is the better one. On equal elements
+ *               it does all the levels anyway ( 320 thousand against 90 thousand ).
+ *              In time ( "Heap Sort Time" chart ) the bottom-up Heap-Sort is 1.1 to 1.15 times faster than heapSort,
+ *               but Quick-Sort is still 1.4 to 1.9 times faster than both: its partitions scan the memory sequentially,
+ *               while the path of a sift-down is a cache miss on every level once the heap doesn't fit in the cache.
+ *
+ *      *Pivot Policies*
+ *          The pivot choice is a template parameter of quickSortPolicy and quickSelectPolicy, and it is used on every
+ *           level of the recursion ( quickSortBestCase and quickSortRandom are the Middle and Random policies ):
+ *              Last, Middle            O(1), but an ordered array makes Last quadratic
+ *              Random                  O(1) with a shared xorshift generator, O(n*log n) expected on every input
+ *              Median-of-3, Ninther    3 and 12 comparisons, the pivot is closer to the median, but there are inputs
+ *                                       made to make them quadratic
+ *              Median-of-Medians       O(n) per level, but the pivot is always between the 30th and 70th percentile,
+ *                                       so the sort is O(n*log n) in the worst case and the select is O(n) ( the
+ *                                       select uses the three-way partition, otherwise equal elements would make
+ *                                       it quadratic )
+ *          The "Pivot <input>" charts compare the operations of the policies on every input shape ( with the Lomuto
+ *           partition, so equal elements are still quadratic for every policy, see the partition strategies ).
+ *
+ *      *Selection with a worst-case bound*
+ *          Intro-Select:
+ *              Quick-Select with the median of three and the three-way partition, but after 2 * log2(n) partitions
+ *               the pivot is chosen with the median of medians, so the worst case is O(n) too.
+ *          Floyd-Rivest:
+ *              A random sample of about n^(2/3) elements is moved to the front of the array, and two elements of it
+ *               are selected ( recursively ) just below and just above the rank where the kth element should be in
+ *               the sample. Partitioning by these two pivots leaves the kth element in the middle part with a very high
+ *               probability, and the middle part only has about n^(2/3) elements, so the expected number of
+ *               comparisons is n + min(k, n - k) + o(n), against about 3.4n for Quick-Select on the median. Below
+ *               FLOYD_RIVEST_CUTOFF elements, and if the sampling fails twice ( the kth element falls outside of the
+ *               middle part, or the middle part stays large because of duplicates ), it continues with Intro-Select,
+ *               so the worst case is O(n) as well.
+ *          The "Selection" charts compare the operations and the time ( microseconds ) of the median search with
+ *           Quick-Select, Intro-Select, Floyd-Rivest and std::nth_element, from 2^20 up to SELECTION_MAX_SIZE elements
+ *           ( the x axis is the size in thousands of elements ).
+ *              Floyd-Rivest does about 4.7 operations per element at every size, Quick-Select and Intro-Select 6 to 8.
+ *               On 16 million elements Floyd-Rivest takes 170 ms, Quick-Select 270 ms, std::nth_element ( which
+ *               doesn't count operations ) 115 ms.
+ *
+ *      *Multi-Select*
+ *          Algorithm:
+ *              Selects several order statistics at once ( for example the 50th, 90th, 99th and 99.9th percentiles ):
+ *               after a three-way partition with a random pivot the sorted list of ranks is split in the ranks before,
+ *               inside and after the equal part, and the algorithm only goes on in the parts which still have ranks.
+ *               A part with a single rank is left to Intro-Select.
+ *          Run Time:
+ *              O(n*log r) for r ranks, while calling Quick-Select r times is O(n*r) ( every call partitions the whole
+ *               array again, only somewhat faster because the previous calls left it partially partitioned ). The
+ *               "Multi Select" charts compare the two for the four percentiles, multiSelect does about half of the
+ *               operations and takes 1.2 to 1.6 times less time.
+ *
+ *      *Antiqsort ( McIlroy's adversary )*
+ *          Algorithm:
+ *              The sort runs on keys whose values are decided only while it compares them. At the start every key is
+ *               "gas" ( larger than everything decided so far ). When two gas keys are compared, one of them is frozen
+ *               to the next smallest "solid" value, preferring the one which was last compared with a solid key,
+ *               because that one is most likely the pivot. So the pivot always turns out to be the smallest remaining
+ *               element, and any Quick-Sort which chooses its pivot with O(1) comparisons becomes quadratic. The final
+ *               values, in the original order of the keys, are an input which makes that sort quadratic.
+ *          Results:
+ *              The "Antiqsort" charts show the operations of every sort on the adversary ( "Antiqsort" series ) and
+ *               on its killer input sorted again as a plain int array ( "Replay" series ). Last, Middle, Median-of-3,
+ *               Ninther and Random all grow quadratically on the adversary, so do the Three-Way and Block strategies
+ *               which use the median of three. The replay gives exactly the same count for every deterministic sort,
+ *               only Random ( and Floyd-Rivest, which takes a random sample ) falls back to O(n*log n), its random
+ *               choices are not part of the input. Median-of-Medians stays O(n*log n). Dual-Pivot is not hurt, two
+ *               pivots from the tertiles are not the "last compared gas key" the adversary assumes. PDQ-Sort and
+ *               Intro-Sort are slowed down by a constant, they switch to Heap-Sort once the adversary made the
+ *               partitions bad, and Intro-Select switches to the median of medians the same way.
+ *
+ *      *Intro-Sort*
+ *          Algorithm:
+ *              Quick-Sort with the median of the first, middle and last element as pivot, which counts its recursion
+ *               depth. Once the depth passes 2 * log2(n), the sub-array is most likely a bad case for the pivot choice,
+ *               so it is sorted with Heap-Sort instead. Sub-arrays smaller than INSERTION_SORT_CUTOFF are left to
+ *               insertion sort.
+ *          Run Time:
+ *              O(n*log n) in every case, the Quick-Sort part can go at most 2 * log2(n) levels deep, and Heap-Sort is
+ *               O(n*log n) anyway. In the "Worst Case" chart it stays flat next to Heap-Sort, while Quick-Sort grows
+ *               quadratically.
+ *
+ *      *Partition Strategies*
+ *          Lomuto:
+ *              The partition above, everything smaller than the pivot goes to the left, everything else to the right.
+ *               Elements equal to the pivot all end up on one side, so an array with only a few distinct values makes
+ *               every partition unbalanced, and an array of equal elements is the O(n^2) worst case again.
+ *          Three-Way ( Bentley-McIlroy ):
+ *              Hoare style scan from both ends, the elements equal to the pivot are swapped to the two ends while
+ *               scanning, and to the middle at the end. The equal block is never touched again, so the run time is
+ *               O(n*log k) for k distinct values, O(n) for equal elements.
+ *          Dual-Pivot ( Yaroslavskiy ):
+ *              Two pivots p <= q split the array into < p, between and > q parts in a single scan. The elements equal
+ *               to p or q are moved to the ends of the middle part before it is sorted, and if p == q the middle part
+ *               is not sorted at all.
+ *          Block ( BlockQuicksort ):
+ *              The comparisons with the pivot don't decide any branch: a block of BLOCK_SIZE elements from the left end
+ *               is scanned and the offsets of the elements >= pivot are written to a buffer, the counter is simply
+ *               incremented by the result of the comparison. The same is done on the right end for the elements
+ *               < pivot, then the buffered elements are swapped pairwise. The remaining few blocks are done by Lomuto.
+ *              Same number of comparisons as Lomuto, but on random arrays Lomuto mispredicts about every second
+ *               comparison, while the block partition only mispredicts at the end of the loops. The "Partition Branch
+ *               Misses" and "Partition Time" charts compare the two ( the misses are 0 if the hardware counters are
+ *               not available ). On 4 million random elements the block partition sorts about 1.7 times faster.
+ *          SIMD:
+ *              8 ( AVX2 ) or 16 ( AVX-512 ) elements are compared to the pivot at once. With AVX2 the bit mask of the
+ *               comparison selects a permutation from a table which moves the smaller elements to the front of the
+ *               vector, and the vector is stored at both write positions ( left and right end ), the write positions
+ *               are moved by the number of smaller and larger elements. AVX-512 has compress stores, so each side
+ *               only gets its own elements. The partition is in place: the first and last vectors are kept in
+ *               registers, and the next vector is always read from the side which has less free space, so a store
+ *               never overwrites an element which was not read yet.
+ *              The instruction set is chosen at run time, without AVX2 the same interface falls back to a scalar,
+ *               branchless Lomuto. The kernels are templates for int and float ( NaNs go to the right side ).
+ *              The "Partition Throughput" chart shows millions of elements partitioned per second. With AVX-512 the
+ *               SIMD kernel partitions 1200 to 2000 million elements per second, about 3 times the block partition
+ *               and 6 to 10 times Lomuto, for floats about 3 times the scalar kernel.
+ *              The SIMD Quick-Sort ( simdQuickSort ) sorts the partitions smaller than NETWORK_SORT_CUTOFF ( at most
+ *               SMALL_NETWORK_MAX_SIZE elements ) with a bitonic sorting network held in 1, 2, 4 or 8 AVX2 registers:
+ *               every compare-exchange is a min and a max, the lanes are paired by permutes and blends, and the unused
+ *               lanes are padded with INT_MAX or +infinity. The "Small Sort Time" chart shows 5 ns for 8 elements
+ *               and 160 ns for 64 against 100 and 1400 ns for insertion sort, the network has no data dependent
+ *               branches to mispredict. With the network as small sort simdQuickSort is about 2 times faster on 4
+ *               million elements.
+ *          The "Few Unique" ( values from 1 to 10 ) and "All Equal" charts compare the operations and the time
+ *           ( microseconds ) of the three strategies, all of them take the median of three as pivot.
+ *              For n = 10000 with few unique values Lomuto does about 5.2 million operations, three-way 140 thousand
+ *               and dual-pivot 97 thousand; on equal elements Lomuto does 50 million against 95 and 20 thousand.
+ *              On random arrays the three are within 20% of each other.
+ *
+ *      *Pattern-Defeating Quick-Sort ( pdqsort )*
+ *          Algorithm:
+ *              Quick-Sort with the median of three ( Tukey's ninther above NINTHER_THRESHOLD elements ) as pivot, which
+ *               looks for patterns:
+ *              - the partition is the block partition, but before it both ends are scanned while they are on the right
+ *                 side, if the scans meet, the array was already partitioned and nothing was swapped
+ *              - if an already partitioned array was also balanced, both halves are tried with an insertion sort which
+ *                 gives up after PARTIAL_INSERTION_LIMIT moves, so a sorted ( or almost sorted ) array is done in O(n)
+ *              - if the element before the sub-array ( a previous pivot ) is equal to the new pivot, the elements equal
+ *                 to it are put to the left and never touched again, so few distinct values cost O(n*log k)
+ *              - an unbalanced partition swaps a few elements around to break the pattern, and after log2(n)
+ *                 unbalanced partitions the sub-array is sorted with Heap-Sort, like in Intro-Sort
+ *          Run Time:
+ *              O(n*log n) in the worst case, O(n) on sorted, reversed and equal arrays. The "PDQ <input>" charts
+ *               compare its time ( microseconds ) to std::sort, the "PDQ Operations" chart shows the linear cases.
+ *              On 1 million elements it is about 1.5 times faster than std::sort on random input, 3 to 5 times faster
+ *               on ascending, few unique and equal input, and about as fast on organ pipe input.
+ *              It is also the kernel of the buckets in the Sample-Sort below.
+ *
+ *      *Work-Stealing Parallel Quick-Sort*
+ *          Algorithm:
+ *              Every thread of the pool has its own deque of tasks, it pushes and pops its own tasks at the back and
+ *               when it runs out of tasks it steals from the front of the deque of a random other thread, the oldest
+ *               ( so the largest ) task there. A thread which waits for its tasks to finish runs tasks meanwhile.
+ *              The sort partitions the array ( with the block partition ), spawns the left part as a new task and goes
+ *               on with the right part. Parts smaller than PARALLEL_GRAIN_SIZE are not split any more, they are sorted
+ *               with pdqsort. The first partitions are the bottleneck ( only one thread could work on them ), so above
+ *               PARALLEL_PARTITION_SIZE the partition itself is done in parallel: every thread counts the elements
+ *               smaller than the pivot in its stripe, and from the prefix sums every thread knows where to copy its
+ *               elements.
+ *          Run Time:
+ *              O(n*log n / p + n) with p threads, the last term is the critical path of the partitions.
+ *              "Strong Scaling" sorts SCALING_SIZE elements with 1, 2, 4, ... threads, "Weak Scaling" sorts
+ *               WEAK_SCALING_SIZE elements per thread. The speedup ( T1 / Tp ) and the efficiency of the weak scaling
+ *               ( T1 / Tp ) are multiplied by 100 in the charts.
+ *
+ *      *Parallel Sample-Sort*
+ *          Algorithm:
+ *              A random sample of the array is sorted and every oversampling-th element of it becomes a splitter, the
+ *               splitters are stored as an implicit binary search tree, so an element finds its bucket without any
+ *               branch ( j = 2 * j + (x > tree[j]) ), elements equal to a splitter go to an equality bucket which
+ *               doesn't have to be sorted at all.
+ *              Each thread classifies a contiguous block of the array and counts its own bucket sizes, the prefix sums
+ *               of these counts give every thread the place where it can write its elements without any locking.
+ *              At the end, the buckets are sorted concurrently with pdqsort, the threads take the
+ *               buckets from the queue of a thread pool.
+ *          Run Time:
+ *              Same number of operations as Quick-Sort ( O(n*log n) ), but the work is split between p threads, so the
+ *               running time is O(n*log n / p) when the buckets are balanced, which the oversampling makes likely.
+ *              The "Sample Sort Scaling" chart shows the time ( microseconds ) as a function of the number of threads.
+ *
+ *      *Auto-Tuning*
+ *          The thresholds of the hybrid sorts depend on the machine ( cache sizes, branch predictor, number of cores ),
+ *           so INSERTION_SORT_CUTOFF, NETWORK_SORT_CUTOFF, BLOCK_SIZE, NINTHER_THRESHOLD and PARALLEL_GRAIN_SIZE are
+ *           only the defaults of sortParameters, which Intro-Sort, pdqsort, the block and SIMD Quick-Sorts and the
+ *           parallel Quick-Sort read. The SIMD Quick-Sort uses NETWORK_SORT_CUTOFF instead of INSERTION_SORT_CUTOFF
+ *           when its small sort is the sorting network ( AVX2 ).
+ *          Running the lab with --tune sorts TUNING_SIZE random elements with every candidate value of one parameter
+ *           after the other ( keeping the best value of the previous ones ), takes the median time of
+ *           TUNING_REPETITIONS runs and writes the fastest values to TUNING_FILE. A normal run loads that file at
+ *           startup, so the tuned values are used without recompiling.
+ *          On the test machine ( 1 core, AVX-512 ) the cutoff goes from 16 to 24 and the block size from 128 to 32,
+ *           which makes pdqsort about 10% faster on 1 million elements, a cutoff of 4 is 20% slower than the best one.
  */
 
 #include <iostream>
 #include <random>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <climits>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <fstream>
+#include <sstream>
 #include "Profiler.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #define MAX_SIZE 10000
+#define INSERTION_SORT_CUTOFF 16
+#define FEW_UNIQUE_VALUES 10
+#define BLOCK_SIZE 128
+#define MAX_BLOCK_SIZE 256
+#define NINTHER_THRESHOLD 128
+#define PARTIAL_INSERTION_LIMIT 8
+#define SAMPLE_SORT_CUTOFF 1024
+#define SAMPLE_SORT_OVERSAMPLING 16
+#define SCALING_SIZE (1 << 22)
+#define WEAK_SCALING_SIZE (1 << 20)
+#define PARALLEL_GRAIN_SIZE (1 << 14)
+#define PARALLEL_PARTITION_SIZE (1 << 20)
+#define FLOYD_RIVEST_CUTOFF 600
+#define SELECTION_MAX_SIZE (1 << 24)
+#define MULTI_SELECT_MAX_SIZE (1 << 22)
+#define PARTITION_THROUGHPUT_MAX_SIZE (1 << 24)
+#define SMALL_NETWORK_MAX_SIZE 64
+#define NETWORK_SORT_CUTOFF 64
+#define SMALL_SORT_REPETITIONS 10000
+#define QUICK_SORT_STACK_SIZE 64
+#define ITERATIVE_MAX_SIZE (1 << 22)
+#define HEAP_SORT_TIME_MAX_SIZE (1 << 22)
+#define TUNING_FILE "sort_tuning.cfg"
+#define TUNING_SIZE (1 << 20)
+#define TUNING_REPETITIONS 5
 
 using namespace std;
 
+enum PartitionStrategy {
+    LOMUTO_PARTITION, THREE_WAY_PARTITION, DUAL_PIVOT_PARTITION, BLOCK_PARTITION, SIMD_PARTITION
+};
+
+const char *partitionStrategyNames[] = {"Lomuto", "Three-Way", "Dual-Pivot", "Block", "SIMD"};
+#define NR_PARTITION_STRATEGIES 5
+
+enum InputShape {
+    RANDOM_INPUT, ASCENDING_INPUT, DESCENDING_INPUT, FEW_UNIQUE_INPUT, ALL_EQUAL_INPUT, ORGAN_PIPE_INPUT
+};
+
+const char *inputShapeNames[] = {"Random", "Ascending", "Descending", "Few Unique", "All Equal", "Organ Pipe"};
+#define NR_INPUT_SHAPES 6
+
+/** Parameters of the hybrid sorts which depend on the machine, the constants above are the defaults
+ */
+struct SortParameters {
+    int insertionSortCutoff;
+    int networkSortCutoff;
+    int blockSize;
+    int nintherThreshold;
+    int parallelGrainSize;
+};
+
+SortParameters sortParameters = {INSERTION_SORT_CUTOFF, NETWORK_SORT_CUTOFF, BLOCK_SIZE, NINTHER_THRESHOLD,
+                                 PARALLEL_GRAIN_SIZE};
+
+/** Loads the parameters from a file of "name value" lines ( lines starting with # are comments ), the parameters
+ *  are only changed if the whole file is valid
+ *
+ * @return  False if the file doesn't exist or is not valid
+ */
+bool loadSortParameters(const char *fileName) {
+    ifstream in(fileName);
+    if (!in) {
+        return false;
+    }
+    SortParameters loaded = sortParameters;
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        istringstream fields(line);
+        string name;
+        int value;
+        if (!(fields >> name >> value)) {
+            cout << fileName << ": bad line \"" << line << "\"" << endl;
+            return false;
+        }
+        if (name == "insertion_sort_cutoff") {
+            loaded.insertionSortCutoff = value;
+        } else if (name == "network_sort_cutoff") {
+            loaded.networkSortCutoff = value;
+        } else if (name == "block_size") {
+            loaded.blockSize = value;
+        } else if (name == "ninther_threshold") {
+            loaded.nintherThreshold = value;
+        } else if (name == "parallel_grain_size") {
+            loaded.parallelGrainSize = value;
+        } else {
+            cout << fileName << ": unknown parameter " << name << endl;
+            return false;
+        }
+    }
+    // pdqsort needs at least 4 elements for its pivot and the offsets of the block partition are unsigned chars
+    if (loaded.insertionSortCutoff < 4 || loaded.networkSortCutoff < 4 ||
+        loaded.networkSortCutoff > SMALL_NETWORK_MAX_SIZE + 1 || loaded.blockSize < 1 ||
+        loaded.blockSize > MAX_BLOCK_SIZE || loaded.nintherThreshold < 8 || loaded.parallelGrainSize < 1) {
+        cout << fileName << ": parameter out of range" << endl;
+        return false;
+    }
+    sortParameters = loaded;
+    return true;
+}
+
+bool saveSortParameters(const char *fileName) {
+    ofstream out(fileName);
+    out << "# parameters of the hybrid sorts measured on this machine, run the lab with --tune to measure again" << endl;
+    out << "insertion_sort_cutoff " << sortParameters.insertionSortCutoff << endl;
+    out << "network_sort_cutoff " << sortParameters.networkSortCutoff << endl;
+    out << "block_size " << sortParameters.blockSize << endl;
+    out << "ninther_threshold " << sortParameters.nintherThreshold << endl;
+    out << "parallel_grain_size " << sortParameters.parallelGrainSize << endl;
+    return (bool) out;
+}
+
 Profiler profiler("QuickSort Advanced Analysis");
-random_device rd;
-mt19937 generator(rd());
+/** xorshift64* generator, a lot cheaper than mt19937 and good enough for choosing pivots and samples
+ */
+class FastRandom {
+public:
+    explicit FastRandom(uint64_t seed) : state((seed << 1) | 1) {
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    /** Uniform random number from [low, high], without division
+     */
+    int between(int low, int high) {
+        return low + (int) (((next() >> 32) * (uint64_t) (high - low + 1)) >> 32);
+    }
+
+private:
+    uint64_t state;
+};
+
+thread_local FastRandom fastRandom(random_device{}());
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int nrThreads) : pending(0), stopping(false) {
+        for (int i = 0; i < nrThreads; i++) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> guard(lock);
+            tasks.push(move(task));
+            pending++;
+        }
+        taskReady.notify_one();
+    }
+
+    /** Blocks until every submitted task is done
+     */
+    void wait() {
+        unique_lock<mutex> guard(lock);
+        allDone.wait(guard, [this] { return pending == 0; });
+    }
+
+    int size() const {
+        return (int) workers.size();
+    }
+
+private:
+    vector<thread> workers;
+    queue<function<void()> > tasks;
+    mutex lock;
+    condition_variable taskReady;
+    condition_variable allDone;
+    int pending;
+    bool stopping;
+
+    void work() {
+        while (true) {
+            function<void()> task;
+            {
+                unique_lock<mutex> guard(lock);
+                taskReady.wait(guard, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = move(tasks.front());
+                tasks.pop();
+            }
+            task();
+            {
+                lock_guard<mutex> guard(lock);
+                pending--;
+            }
+            allDone.notify_all();
+        }
+    }
+};
+
+/** Thread pool where every thread has its own deque of tasks and steals from the others when it has nothing to do
+ *  The thread which creates the pool is worker 0, it only runs tasks while it waits for a group of tasks
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int nrThreads) : queues(new WorkerQueue[nrThreads]), nrQueues(nrThreads), queued(0),
+                                               stopping(false) {
+        for (int i = 1; i < nrThreads; i++) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> guard(sleepLock);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    /** Pushes the task to the deque of the calling thread, pending is decremented when the task is done
+     */
+    void spawn(atomic<int> &pending, function<void()> task) {
+        pending++;
+        WorkerQueue &queue = queues[currentPool == this ? currentWorker : 0];
+        {
+            lock_guard<mutex> guard(queue.lock);
+            queue.tasks.emplace_back([&pending, task] {
+                task();
+                pending--;
+            });
+        }
+        queued++;
+        taskReady.notify_one();
+    }
+
+    /** Runs tasks until every task of the group is done
+     */
+    void wait(atomic<int> &pending) {
+        int self = currentPool == this ? currentWorker : 0;
+        while (pending > 0) {
+            if (!runOne(self)) {
+                this_thread::yield();
+            }
+        }
+    }
+
+    int size() const {
+        return nrQueues;
+    }
+
+private:
+    struct WorkerQueue {
+        mutex lock;
+        deque<function<void()> > tasks;
+    };
+
+    static thread_local WorkStealingPool *currentPool;
+    static thread_local int currentWorker;
+
+    unique_ptr<WorkerQueue[]> queues;
+    int nrQueues;
+    vector<thread> workers;
+    atomic<int> queued;
+    mutex sleepLock;
+    condition_variable taskReady;
+    bool stopping;
+
+    /** Runs the newest task of the own deque, or the oldest task of another one
+     *
+     * @return  false if there was no task
+     */
+    bool runOne(int self) {
+        function<void()> task;
+        {
+            WorkerQueue &own = queues[self];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+        // the own deque was just found empty, so the victim is always one of the other nrQueues - 1 deques
+        for (int attempt = 0; !task && attempt < nrQueues - 1; attempt++) {
+            WorkerQueue &victim = queues[(self + 1 + fastRandom.between(0, nrQueues - 2)) % nrQueues];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task) {
+            return false;
+        }
+        queued--;
+        task();
+        return true;
+    }
+
+    void work(int self) {
+        currentPool = this;
+        currentWorker = self;
+        while (true) {
+            if (runOne(self)) {
+                continue;
+            }
+            unique_lock<mutex> guard(sleepLock);
+            if (stopping) {
+                return;
+            }
+            taskReady.wait_for(guard, chrono::milliseconds(1), [this] { return stopping || queued > 0; });
+        }
+    }
+};
 
-int partition(int array[], int low, int high, int pivotIndex, Operation op) {
+thread_local WorkStealingPool *WorkStealingPool::currentPool = NULL;
+thread_local int WorkStealingPool::currentWorker = 0;
+
+template<typename T>
+int partition(T array[], int low, int high, int pivotIndex, Operation op) {
     if (pivotIndex != high) {
         swap(array[pivotIndex], array[high]);
         op.count(3);
     }
-    int pivot = array[high];
+    T pivot = array[high];
     op.count();
     int i = low - 1;
     for (int j = low; j < high; j++) {
@@ -84,174 +652,2481 @@ void quickSort(int array[], int low, int high, Operation op) {
     quickSort(array, pivot + 1, high, op);
 }
 
-void quickSortBestCase(int array[], int low, int high, Operation op) {
-    op.count();
-    if (low >= high) {
-        return;
+template<typename T>
+void insertionSort(T array[], int low, int high, Operation op) {
+    for (int i = low + 1; i <= high; i++) {
+        T key = array[i];
+        int j = i - 1;
+        op.count(2);
+        while (j >= low && array[j] > key) {
+            array[j + 1] = array[j];
+            j--;
+            op.count(2);
+        }
+        array[j + 1] = key;
     }
-    int pivotIndex = (low + high) / 2;
-    int pivot = partition(array, low, high, pivotIndex, op);
-    quickSort(array, low, pivot - 1, op);
-    quickSort(array, pivot + 1, high, op);
 }
 
-void quickSortRandom(int array[], int low, int high, Operation op) {
+template<typename T>
+int medianOfThree(T array[], int a, int b, int c, Operation op) {
+    op.count(3);
+    if (array[a] < array[b]) {
+        return array[b] < array[c] ? b : (array[a] < array[c] ? c : a);
+    }
+    return array[a] < array[c] ? a : (array[b] < array[c] ? c : b);
+}
+
+template<typename PivotPolicy, typename T>
+int quickSelectPolicy(T array[], int low, int high, int k, Operation op);
+
+template<typename T>
+void partitionThreeWay(T array[], int low, int high, int pivotIndex, int &lt, int &gt, Operation op);
+
+/** Pivot selection policies, select() returns the index of the pivot in array[low..high]
+ */
+struct LastPivot {
+    template<typename T>
+    static int select(T[], int, int high, Operation) {
+        return high;
+    }
+};
+
+struct MiddlePivot {
+    template<typename T>
+    static int select(T[], int low, int high, Operation) {
+        return low + (high - low) / 2;
+    }
+};
+
+struct RandomPivot {
+    template<typename T>
+    static int select(T[], int low, int high, Operation) {
+        return fastRandom.between(low, high);
+    }
+};
+
+struct MedianOfThreePivot {
+    template<typename T>
+    static int select(T array[], int low, int high, Operation op) {
+        return medianOfThree(array, low, low + (high - low) / 2, high, op);
+    }
+};
+
+/** Tukey's ninther, the median of the medians of three evenly spaced triples
+ */
+struct NintherPivot {
+    template<typename T>
+    static int select(T array[], int low, int high, Operation op) {
+        int step = (high - low) / 8, mid = low + (high - low) / 2;
+        if (step == 0) {
+            return medianOfThree(array, low, mid, high, op);
+        }
+        int first = medianOfThree(array, low, low + step, low + 2 * step, op);
+        int second = medianOfThree(array, mid - step, mid, mid + step, op);
+        int third = medianOfThree(array, high - 2 * step, high - step, high, op);
+        return medianOfThree(array, first, second, third, op);
+    }
+};
+
+/** Blum-Floyd-Pratt-Rivest-Tarjan median of medians, the medians of the groups of 5 are moved to the front and their
+ *  median is selected recursively, the pivot is guaranteed to be between the 30th and the 70th percentile
+ */
+struct MedianOfMediansPivot {
+    template<typename T>
+    static int select(T array[], int low, int high, Operation op) {
+        int n = high - low + 1;
+        if (n <= 5) {
+            insertionSort(array, low, high, op);
+            return low + (high - low) / 2;
+        }
+        int groups = 0;
+        for (int i = low; i <= high; i += 5, groups++) {
+            int last = min(i + 4, high);
+            insertionSort(array, i, last, op);
+            op.count(3);
+            swap(array[low + groups], array[i + (last - i) / 2]);
+        }
+        return quickSelectPolicy<MedianOfMediansPivot>(array, low, low + groups - 1, low + (groups - 1) / 2, op);
+    }
+};
+
+const char *pivotPolicyNames[] = {"Last", "Middle", "Random", "Median-of-3", "Ninther", "Median-of-Medians"};
+#define NR_PIVOT_POLICIES 6
+
+/** Quick-Sort which chooses the pivot with the given policy on every level
+ *
+ * @tparam PivotPolicy
+ * @tparam T        Element type, compared with <, > and ==
+ * @param array
+ * @param low
+ * @param high
+ * @param op
+ */
+template<typename PivotPolicy, typename T>
+void quickSortPolicy(T array[], int low, int high, Operation op) {
     op.count();
     if (low >= high) {
         return;
     }
-    uniform_int_distribution<int> distribution(low, high);
-    int pivotIndex = distribution(generator);
-    int pivot = partition(array, low, high, pivotIndex, op);
-    quickSort(array, low, pivot - 1, op);
-    quickSort(array, pivot + 1, high, op);
+    int pivot = partition(array, low, high, PivotPolicy::select(array, low, high, op), op);
+    quickSortPolicy<PivotPolicy>(array, low, pivot - 1, op);
+    quickSortPolicy<PivotPolicy>(array, pivot + 1, high, op);
 }
 
-int quickSelectFind(int array[], int low, int high, int k, Operation op) {
-    if (low == high) {
-        return array[low];
-    }
-    uniform_int_distribution<int> distribution(low, high);
-    int pivotIndex = distribution(generator);
-    pivotIndex = partition(array, low, high, pivotIndex, op);
-    if (k == pivotIndex) {
-        return array[k];
-    } else if (k < pivotIndex) {
-        return quickSelectFind(array, low, pivotIndex - 1, k, op);
-    } else {
-        return quickSelectFind(array, pivotIndex + 1, high, k, op);
+/** Same result and operations as quickSortPolicy, without recursion: the larger part is pushed on an explicit stack
+ *  and the loop goes on with the smaller one. Every part on the stack is at least twice as large as the parts pushed
+ *  after it, so the stack never holds more than log2(n) parts, QUICK_SORT_STACK_SIZE is enough for any int size.
+ */
+template<typename PivotPolicy, typename T>
+void quickSortIterative(T array[], int low, int high, Operation op) {
+    int stackLow[QUICK_SORT_STACK_SIZE], stackHigh[QUICK_SORT_STACK_SIZE];
+    int top = 0;
+    while (true) {
+        op.count();
+        if (low >= high) {
+            if (top == 0) {
+                return;
+            }
+            top--;
+            low = stackLow[top];
+            high = stackHigh[top];
+            continue;
+        }
+        int pivot = partition(array, low, high, PivotPolicy::select(array, low, high, op), op);
+        if (pivot - low < high - pivot) {
+            stackLow[top] = pivot + 1;
+            stackHigh[top] = high;
+            high = pivot - 1;
+        } else {
+            stackLow[top] = low;
+            stackHigh[top] = pivot - 1;
+            low = pivot + 1;
+        }
+        top++;
     }
 }
 
-int quickSelect(int array[], int low, int high, int k, Operation op) {
-    return quickSelectFind(array, low, high, k - 1, op);
+/** Moves the kth smallest element ( k is an index in [low, high] ) to its place and returns its index
+ *  The partition is three-way, so the elements equal to the pivot are done in one step
+ */
+template<typename PivotPolicy, typename T>
+int quickSelectPolicy(T array[], int low, int high, int k, Operation op) {
+    while (low < high) {
+        int lt, gt;
+        partitionThreeWay(array, low, high, PivotPolicy::select(array, low, high, op), lt, gt, op);
+        if (k < lt) {
+            high = lt - 1;
+        } else if (k > gt) {
+            low = gt + 1;
+        } else {
+            return k;
+        }
+    }
+    return k;
 }
 
-bool verifyIndex(int i, int n) {
-    if (i < 0) return false;
-    return i < n;
+void quickSortBestCase(int array[], int low, int high, Operation op) {
+    quickSortPolicy<MiddlePivot>(array, low, high, op);
 }
 
-int getLeftChildIndex(int i) {
-    int key = i << 1;
-    return key + 1;
+void quickSortRandom(int array[], int low, int high, Operation op) {
+    quickSortPolicy<RandomPivot>(array, low, high, op);
 }
 
-int getRightChildIndex(int i) {
-    int key = i << 1;
-    return key + 2;
+int quickSelectFind(int array[], int low, int high, int k, Operation op) {
+    return array[quickSelectPolicy<RandomPivot>(array, low, high, k, op)];
 }
 
-void maxHeapifyBottom(int *a, int i, int n, Operation op) {
-    int leftChildIndex = getLeftChildIndex(i);
-    int rightChildIndex = getRightChildIndex(i);
-    op.count(2);
-    if (verifyIndex(rightChildIndex, n) && (a[rightChildIndex] > a[i]) && (a[rightChildIndex] > a[leftChildIndex])) {
-        swap(a[rightChildIndex], a[i]);
-        op.count(3);
-        maxHeapifyBottom(a, rightChildIndex, n, op);
-    } else {
-        op.count(1);
-        if (verifyIndex(leftChildIndex, n) && a[leftChildIndex] > a[i]) {
-            swap(a[leftChildIndex], a[i]);
-            op.count(3);
-            maxHeapifyBottom(a, leftChildIndex, n, op);
+int quickSelect(int array[], int low, int high, int k, Operation op) {
+    return quickSelectFind(array, low, high, k - 1, op);
+}
+
+/** Quick-Select which switches to the median of medians pivot after 2 * log2(n) partitions
+ *
+ * @return  The index of the kth smallest element ( k is an index in [low, high] ), which is moved to its place
+ */
+template<typename T>
+int introSelect(T array[], int low, int high, int k, Operation op) {
+    int budget = 0;
+    for (int i = high - low + 1; i > 1; i >>= 1) {
+        budget += 2;
+    }
+    while (low < high) {
+        if (budget-- == 0) {
+            return quickSelectPolicy<MedianOfMediansPivot>(array, low, high, k, op);
+        }
+        int lt, gt;
+        partitionThreeWay(array, low, high, medianOfThree(array, low, low + (high - low) / 2, high, op), lt, gt, op);
+        if (k < lt) {
+            high = lt - 1;
+        } else if (k > gt) {
+            low = gt + 1;
+        } else {
+            return k;
         }
     }
+    return k;
 }
 
-void buildMaxHeapBottomUp(int a[], int n, Operation op) {
-    for (int i = n / 2; i >= 0; i--) {
-        maxHeapifyBottom(a, i, n, op);
+/** Partitions array[low..high] by two values u <= v, after it array[low..lt-1] < u, u <= array[lt..gt] <= v and
+ *  array[gt+1..high] > v
+ */
+template<typename T>
+void partitionByRange(T array[], int low, int high, T u, T v, int &lt, int &gt, Operation op) {
+    int i = low;
+    lt = low;
+    gt = high;
+    while (i <= gt) {
+        op.count();
+        if (array[i] < u) {
+            op.count(3);
+            swap(array[lt++], array[i++]);
+        } else {
+            op.count();
+            if (array[i] > v) {
+                op.count(3);
+                swap(array[i], array[gt--]);
+            } else {
+                i++;
+            }
+        }
     }
 }
 
-void heapSort(int a[], int n, Operation op) {
-    buildMaxHeapBottomUp(a, n, op);
-    for (int i = n - 1; i > 0; i--) {
-        op.count(3);
-        swap(a[0], a[i]);
-        n--;
-        maxHeapifyBottom(a, 0, n, op);
+/** Floyd-Rivest selection, two pivots are selected from a random sample so that the kth element is between them
+ *
+ * @return  The index of the kth smallest element ( k is an index in [low, high] ), which is moved to its place
+ */
+template<typename T>
+int floydRivestSelect(T array[], int low, int high, int k, Operation op) {
+    int misses = 0;
+    while (high - low + 1 > FLOYD_RIVEST_CUTOFF && misses < 2) {
+        int n = high - low + 1;
+        double logN = log((double) n);
+        int sampleSize = (int) (pow((double) n, 2.0 / 3.0) * pow(logN, 1.0 / 3.0));
+        int gap = (int) sqrt(sampleSize * logN);
+        for (int i = 0; i < sampleSize; i++) {
+            op.count(3);
+            swap(array[low + i], array[fastRandom.between(low + i, high)]);
+        }
+        int rank = (int) ((long long) (k - low) * sampleSize / n);
+        int lowRank = low + max(0, rank - gap), highRank = low + min(sampleSize - 1, rank + gap);
+        T u = array[floydRivestSelect(array, low, low + sampleSize - 1, lowRank, op)];
+        T v = array[floydRivestSelect(array, lowRank, low + sampleSize - 1, highRank, op)];
+
+        int lt, gt;
+        partitionByRange(array, low, high, u, v, lt, gt, op);
+        if (k < lt) {
+            high = lt - 1;
+            misses++;
+        } else if (k > gt) {
+            low = gt + 1;
+            misses++;
+        } else {
+            op.count();
+            if (u == v) {
+                return k;
+            }
+            // many copies of the pivots can keep the middle part large
+            if (gt - lt + 1 > n / 2) {
+                misses++;
+            }
+            low = lt;
+            high = gt;
+        }
     }
+    return introSelect(array, low, high, k, op);
 }
 
-void printArray(int array[], int n) {
-    for (int i = 0; i < n; i++) {
-        cout << array[i] << " ";
+void multiSelect(int array[], int low, int high, const int ranks[], int nrRanks, Operation op) {
+    while (nrRanks > 0 && low < high) {
+        if (nrRanks == 1) {
+            introSelect(array, low, high, ranks[0], op);
+            return;
+        }
+        int lt, gt;
+        partitionThreeWay(array, low, high, fastRandom.between(low, high), lt, gt, op);
+        int before = (int) (lower_bound(ranks, ranks + nrRanks, lt) - ranks);
+        int notAfter = (int) (upper_bound(ranks, ranks + nrRanks, gt) - ranks);
+        multiSelect(array, low, lt - 1, ranks, before, op);
+        ranks += notAfter;
+        nrRanks -= notAfter;
+        low = gt + 1;
     }
-    cout << endl;
 }
 
-void worstCase(int n) {
-    int testArray[MAX_SIZE];
-    FillRandomArray(testArray, n, 1, 10000, false, 2);
-    int a[MAX_SIZE];
-    int b[MAX_SIZE];
-    CopyArray(a, testArray, MAX_SIZE);
-    CopyArray(b, testArray, MAX_SIZE);
-    Operation worstCaseQuickSort = profiler.createOperation("Worst Quick Sort", n);
-    Operation worstCaseHeapSort = profiler.createOperation("Worst Heap Sort", n);
-    quickSort(a, 0, n - 1, worstCaseQuickSort);
-    heapSort(b, n, worstCaseHeapSort);
+/** Finds several order statistics in one pass, every requested element is moved to its place
+ *
+ * @param array
+ * @param n         Size of the array
+ * @param ranks     Indexes in increasing order ( the 0th is the smallest element )
+ * @param op
+ * @return          The elements with the given ranks
+ */
+vector<int> multiSelect(int array[], int n, const vector<int> &ranks, Operation op) {
+    multiSelect(array, 0, n - 1, ranks.data(), (int) ranks.size(), op);
+    vector<int> result;
+    for (int rank : ranks) {
+        result.push_back(array[rank]);
+    }
+    return result;
 }
 
-void bestCase(int n) {
-    int testArray[MAX_SIZE];
-    FillRandomArray(testArray, n, 1, 10000, false, 1);
-    int a[MAX_SIZE];
-    int b[MAX_SIZE];
-    CopyArray(a, testArray, MAX_SIZE);
-    CopyArray(b, testArray, MAX_SIZE);
-    Operation bestCaseQuickSort = profiler.createOperation("Best Quick Sort", n);
-    Operation bestCaseHeapSort = profiler.createOperation("Best Heap Sort", n);
-    quickSortBestCase(testArray, 0, n - 1, bestCaseQuickSort);
-    heapSort(b, n, bestCaseHeapSort);
+template<typename T>
+void pdqSort(T array[], int n, Operation op);
 
+/** Finds the bucket of x in the implicit search tree of the splitters ( tree[1..nrBuckets-1] ), without branches
+ *  Buckets 2*b hold the elements between splitter b-1 and b, buckets 2*b+1 the elements equal to splitter b
+ */
+inline int classify(int x, const int tree[], const int splitters[], int levels, int nrBuckets) {
+    int j = 1;
+    for (int l = 0; l < levels; l++) {
+        j = 2 * j + (x > tree[j]);
+    }
+    int b = j - nrBuckets;
+    return 2 * b + (x == splitters[b]);
 }
 
-void averageCase(int n) {
-    int testArray[MAX_SIZE];
-    FillRandomArray(testArray, n, 1, 10000, false, 0);
-    int a[MAX_SIZE];
-    int b[MAX_SIZE];
-    CopyArray(a, testArray, MAX_SIZE);
-    CopyArray(b, testArray, MAX_SIZE);
-    Operation averageCaseQuickSort = profiler.createOperation("Average Quick Sort", n);
-    Operation averageCaseHeapSort = profiler.createOperation("Average Heap Sort", n);
-    quickSortRandom(testArray, 0, n - 1, averageCaseQuickSort);
-    heapSort(b, n, averageCaseHeapSort);
+void buildSplitterTree(const int splitters[], int tree[], int node, int low, int high) {
+    if (low > high) {
+        return;
+    }
+    int mid = (low + high) / 2;
+    tree[node] = splitters[mid];
+    buildSplitterTree(splitters, tree, 2 * node, low, mid - 1);
+    buildSplitterTree(splitters, tree, 2 * node + 1, mid + 1, high);
 }
 
-void runTests() {
-    for (int i = 100; i <= 10000; i += 100) {
-        worstCase(i);
-        bestCase(i);
-        for (int j = 0; j < 5; j++) {
-            averageCase(i);
+/** Sorts the array in increasing order on the threads of the given pool
+ *  Method implemented: Parallel Sample-Sort, the buckets are sorted with pdqSort
+ *  Every thread counts its operations in its own Profiler, they are added to op when the threads are done
+ *
+ * @param array
+ * @param n         Size of the array
+ * @param pool
+ * @param op
+ */
+void sampleSort(int array[], int n, ThreadPool &pool, Operation op) {
+    if (n < SAMPLE_SORT_CUTOFF) {
+        pdqSort(array, n, op);
+        return;
+    }
+    int nrThreads = pool.size();
+    int nrBuckets = 16, levels = 4;
+    while (nrBuckets < 4 * nrThreads && nrBuckets < 256) {
+        nrBuckets <<= 1;
+        levels++;
+    }
+
+    int sampleSize = SAMPLE_SORT_OVERSAMPLING * nrBuckets - 1;
+    vector<int> sample(sampleSize);
+    for (int i = 0; i < sampleSize; i++) {
+        sample[i] = array[fastRandom.between(0, n - 1)];
+    }
+    op.count(sampleSize);
+    pdqSort(sample.data(), sampleSize, op);
+    vector<int> splitters(nrBuckets);
+    for (int i = 0; i < nrBuckets - 1; i++) {
+        splitters[i] = sample[(i + 1) * SAMPLE_SORT_OVERSAMPLING - 1];
+    }
+    splitters[nrBuckets - 1] = INT_MAX;
+    vector<int> tree(nrBuckets);
+    buildSplitterTree(splitters.data(), tree.data(), 1, 0, nrBuckets - 2);
+
+    int stripe = (n + nrThreads - 1) / nrThreads;
+    vector<unsigned short> bucketOf(n);
+    vector<vector<int> > counts(nrThreads, vector<int>(2 * nrBuckets, 0));
+    vector<int> threadOps(nrThreads, 0);
+    for (int t = 0; t < nrThreads; t++) {
+        pool.submit([&, t] {
+            int from = min(n, t * stripe), to = min(n, from + stripe);
+            for (int i = from; i < to; i++) {
+                int bucket = classify(array[i], tree.data(), splitters.data(), levels, nrBuckets);
+                bucketOf[i] = (unsigned short) bucket;
+                counts[t][bucket]++;
+            }
+            threadOps[t] = (to - from) * (levels + 2);
+        });
+    }
+    pool.wait();
+
+    vector<int> bucketStart(2 * nrBuckets + 1, 0);
+    for (int b = 0; b < 2 * nrBuckets; b++) {
+        int offset = bucketStart[b];
+        for (int t = 0; t < nrThreads; t++) {
+            int count = counts[t][b];
+            counts[t][b] = offset;
+            offset += count;
         }
+        bucketStart[b + 1] = offset;
     }
-    profiler.divideValues("Average Quick Sort", 5);
-    profiler.divideValues("Average Heap Sort", 5);
-    profiler.createGroup("Average Case", "Average Quick Sort", "Average Heap Sort");
-    profiler.createGroup("Best Case", "Best Quick Sort", "Best Heap Sort");
-    profiler.createGroup("Worst Case", "Worst Quick Sort", "Worst Heap Sort");
-    profiler.showReport();
-}
 
-void exemplifyCorrectness(int n) {
-    int testArray[MAX_SIZE];
-    FillRandomArray(testArray, n, 1, 10, true, 2);
+    vector<int> buffer(n);
+    for (int t = 0; t < nrThreads; t++) {
+        pool.submit([&, t] {
+            int from = min(n, t * stripe), to = min(n, from + stripe);
+            for (int i = from; i < to; i++) {
+                buffer[counts[t][bucketOf[i]]++] = array[i];
+            }
+            threadOps[t] += to - from;
+        });
+    }
+    pool.wait();
+
+    vector<int> bucketOps(2 * nrBuckets, 0);
+    for (int b = 0; b < 2 * nrBuckets; b++) {
+        pool.submit([&, b] {
+            int low = bucketStart[b], high = bucketStart[b + 1];
+            if (b % 2 == 0 && high - low > 1) {
+                Profiler local;
+                Operation localOp = local.createOperation("Bucket", high - low);
+                pdqSort(buffer.data() + low, high - low, localOp);
+                bucketOps[b] = localOp.get();
+            }
+            copy(buffer.begin() + low, buffer.begin() + high, array + low);
+            bucketOps[b] += high - low;
+        });
+    }
+    pool.wait();
+
+    for (int t = 0; t < nrThreads; t++) {
+        op.count(threadOps[t]);
+    }
+    for (int b = 0; b < 2 * nrBuckets; b++) {
+        op.count(bucketOps[b]);
+    }
+}
+
+template<typename T>
+void heapSort(T a[], int n, Operation op);
+
+/** Bentley-McIlroy three-way partition, after it array[low..lt-1] < pivot, array[lt..gt] == pivot and
+ *  array[gt+1..high] > pivot
+ */
+template<typename T>
+void partitionThreeWay(T array[], int low, int high, int pivotIndex, int &lt, int &gt, Operation op) {
+    op.count(3);
+    swap(array[pivotIndex], array[high]);
+    T pivot = array[high];
+    int i = low - 1, j = high, p = low - 1, q = high;
+    while (true) {
+        op.count();
+        while (array[++i] < pivot) {
+            op.count();
+        }
+        op.count();
+        while (pivot < array[--j]) {
+            op.count();
+            if (j == low) {
+                break;
+            }
+        }
+        if (i >= j) {
+            break;
+        }
+        op.count(5);
+        swap(array[i], array[j]);
+        if (array[i] == pivot) {
+            op.count(3);
+            swap(array[++p], array[i]);
+        }
+        if (array[j] == pivot) {
+            op.count(3);
+            swap(array[--q], array[j]);
+        }
+    }
+    op.count(3);
+    swap(array[i], array[high]);
+    j = i - 1;
+    i = i + 1;
+    for (int k = low; k <= p; k++, j--) {
+        op.count(3);
+        swap(array[k], array[j]);
+    }
+    for (int k = high - 1; k >= q; k--, i++) {
+        op.count(3);
+        swap(array[k], array[i]);
+    }
+    lt = j + 1;
+    gt = i - 1;
+}
+
+/** Yaroslavskiy dual-pivot partition, the pivots are taken from the tertiles, after it
+ *  array[low..lp-1] < array[lp] <= array[lp+1..rp-1] <= array[rp] < array[rp+1..high]
+ */
+template<typename T>
+void partitionDualPivot(T array[], int low, int high, int &lp, int &rp, Operation op) {
+    int third = (high - low) / 3;
+    op.count(7);
+    swap(array[low], array[low + third]);
+    swap(array[high], array[high - third]);
+    if (array[low] > array[high]) {
+        op.count(3);
+        swap(array[low], array[high]);
+    }
+    T p = array[low], q = array[high];
+    int l = low + 1, g = high - 1;
+    for (int k = l; k <= g; k++) {
+        op.count();
+        if (array[k] < p) {
+            op.count(3);
+            swap(array[k], array[l++]);
+        } else {
+            op.count();
+            if (array[k] > q) {
+                op.count();
+                while (array[g] > q && k < g) {
+                    op.count();
+                    g--;
+                }
+                op.count(4);
+                swap(array[k], array[g--]);
+                if (array[k] < p) {
+                    op.count(3);
+                    swap(array[k], array[l++]);
+                }
+            }
+        }
+    }
+    op.count(6);
+    swap(array[low], array[--l]);
+    swap(array[high], array[++g]);
+    lp = l;
+    rp = g;
+}
+
+/** Block partition ( Edelkamp and Weiss ) of array[l..r] around the given pivot value, the comparisons only produce
+ *  offsets, the swaps are done in a second pass, so there are no branches depending on the data
+ *
+ * @return  The first index of the elements >= pivot
+ */
+template<typename T>
+int blockPartitionRange(T array[], int l, int r, T pivot, Operation op) {
+    unsigned char offsetsLeft[MAX_BLOCK_SIZE], offsetsRight[MAX_BLOCK_SIZE];
+    int blockSize = sortParameters.blockSize;
+    int startLeft = 0, numLeft = 0, startRight = 0, numRight = 0;
+    while (r - l + 1 >= 2 * blockSize) {
+        if (numLeft == 0) {
+            startLeft = 0;
+            for (int i = 0; i < blockSize; i++) {
+                offsetsLeft[numLeft] = (unsigned char) i;
+                numLeft += !(array[l + i] < pivot);
+            }
+            op.count(blockSize);
+        }
+        if (numRight == 0) {
+            startRight = 0;
+            for (int i = 0; i < blockSize; i++) {
+                offsetsRight[numRight] = (unsigned char) i;
+                numRight += array[r - i] < pivot;
+            }
+            op.count(blockSize);
+        }
+        int num = min(numLeft, numRight);
+        for (int k = 0; k < num; k++) {
+            swap(array[l + offsetsLeft[startLeft + k]], array[r - offsetsRight[startRight + k]]);
+        }
+        op.count(3 * num);
+        numLeft -= num;
+        numRight -= num;
+        startLeft += num;
+        startRight += num;
+        if (numLeft == 0) {
+            l += blockSize;
+        }
+        if (numRight == 0) {
+            r -= blockSize;
+        }
+    }
+
+    // everything before l is < pivot and everything after r is >= pivot, the rest is done by Lomuto
+    int i = l - 1;
+    for (int j = l; j <= r; j++) {
+        op.count();
+        if (array[j] < pivot) {
+            i++;
+            op.count(3);
+            swap(array[i], array[j]);
+        }
+    }
+    return i + 1;
+}
+
+/** Same result as partition(), with the block partition
+ */
+template<typename T>
+int partitionBlock(T array[], int low, int high, int pivotIndex, Operation op) {
+    op.count(7);
+    swap(array[pivotIndex], array[high]);
+    T pivot = array[high];
+    int boundary = blockPartitionRange(array, low, high - 1, pivot, op);
+    swap(array[boundary], array[high]);
+    return boundary;
+}
+
+/** Branchless Lomuto partition of array[l..r] around the given pivot value, the fallback of the SIMD kernels
+ *
+ * @return  The first index of the elements >= pivot
+ */
+template<typename T>
+int partitionRangeScalar(T array[], int l, int r, T pivot) {
+    int i = l;
+    for (int j = l; j <= r; j++) {
+        T x = array[j];
+        array[j] = array[i];
+        array[i] = x;
+        i += x < pivot;
+    }
+    return i;
+}
+
+#ifdef HAS_X86_SIMD
+
+/** For every 8 bit mask: the indexes of the set bits, then the indexes of the other bits
+ */
+struct PermutationTable {
+    int indexes[256][8];
+
+    PermutationTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            int k = 0;
+            for (int i = 0; i < 8; i++) {
+                if (mask >> i & 1) {
+                    indexes[mask][k++] = i;
+                }
+            }
+            for (int i = 0; i < 8; i++) {
+                if (!(mask >> i & 1)) {
+                    indexes[mask][k++] = i;
+                }
+            }
+        }
+    }
+};
+
+static const PermutationTable permutationTable;
+
+bool hasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    return supported;
+}
+
+bool hasAvx512() {
+    static const bool supported = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+    return supported;
+}
+
+__attribute__((target("avx2"))) inline int lessMaskAvx2(__m256i v, int pivot) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(pivot), v)));
+}
+
+__attribute__((target("avx2"))) inline int lessMaskAvx2(__m256i v, float pivot) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(v), _mm256_set1_ps(pivot), _CMP_LT_OQ));
+}
+
+template<typename T>
+__attribute__((target("avx2,popcnt"))) inline void partitionVectorAvx2(__m256i v, T pivot, T array[], int &writeLeft,
+                                                                        int &writeRight) {
+    int mask = lessMaskAvx2(v, pivot);
+    int count = _mm_popcnt_u32(mask);
+    __m256i permutation = _mm256_loadu_si256((const __m256i *) permutationTable.indexes[mask]);
+    __m256i permuted = _mm256_permutevar8x32_epi32(v, permutation);
+    _mm256_storeu_si256((__m256i *) (array + writeLeft), permuted);
+    _mm256_storeu_si256((__m256i *) (array + writeRight - 8), permuted);
+    writeLeft += count;
+    writeRight -= 8 - count;
+}
+
+template<typename T>
+__attribute__((target("avx2,popcnt"))) int partitionRangeAvx2(T array[], int l, int r, T pivot) {
+    if (r - l + 1 < 16) {
+        return partitionRangeScalar(array, l, r, pivot);
+    }
+    __m256i savedLeft = _mm256_loadu_si256((const __m256i *) (array + l));
+    __m256i savedRight = _mm256_loadu_si256((const __m256i *) (array + r - 7));
+    int readLeft = l + 8, readRight = r - 7;
+    int writeLeft = l, writeRight = r + 1;
+    while (readRight - readLeft >= 8) {
+        __m256i v;
+        if (readLeft - writeLeft <= writeRight - readRight) {
+            v = _mm256_loadu_si256((const __m256i *) (array + readLeft));
+            readLeft += 8;
+        } else {
+            readRight -= 8;
+            v = _mm256_loadu_si256((const __m256i *) (array + readRight));
+        }
+        partitionVectorAvx2(v, pivot, array, writeLeft, writeRight);
+    }
+
+    // less than a vector is left unread, it is placed one by one together with the two saved vectors
+    T rest[24];
+    int m = 0;
+    for (int i = readLeft; i < readRight; i++) {
+        rest[m++] = array[i];
+    }
+    _mm256_storeu_si256((__m256i *) (rest + m), savedLeft);
+    _mm256_storeu_si256((__m256i *) (rest + m + 8), savedRight);
+    m += 16;
+    for (int i = 0; i < m; i++) {
+        if (rest[i] < pivot) {
+            array[writeLeft++] = rest[i];
+        } else {
+            array[--writeRight] = rest[i];
+        }
+    }
+    return writeLeft;
+}
+
+__attribute__((target("avx512f"))) inline __mmask16 lessMaskAvx512(__m512i v, int pivot) {
+    return _mm512_cmplt_epi32_mask(v, _mm512_set1_epi32(pivot));
+}
+
+__attribute__((target("avx512f"))) inline __mmask16 lessMaskAvx512(__m512i v, float pivot) {
+    return _mm512_cmp_ps_mask(_mm512_castsi512_ps(v), _mm512_set1_ps(pivot), _CMP_LT_OQ);
+}
+
+template<typename T>
+__attribute__((target("avx512f,popcnt"))) int partitionRangeAvx512(T array[], int l, int r, T pivot) {
+    if (r - l + 1 < 32) {
+        return partitionRangeScalar(array, l, r, pivot);
+    }
+    __m512i savedLeft = _mm512_loadu_si512(array + l);
+    __m512i savedRight = _mm512_loadu_si512(array + r - 15);
+    int readLeft = l + 16, readRight = r - 15;
+    int writeLeft = l, writeRight = r + 1;
+    while (readRight - readLeft >= 16) {
+        __m512i v;
+        if (readLeft - writeLeft <= writeRight - readRight) {
+            v = _mm512_loadu_si512(array + readLeft);
+            readLeft += 16;
+        } else {
+            readRight -= 16;
+            v = _mm512_loadu_si512(array + readRight);
+        }
+        __mmask16 mask = lessMaskAvx512(v, pivot);
+        int count = _mm_popcnt_u32(mask);
+        _mm512_mask_compressstoreu_epi32(array + writeLeft, mask, v);
+        _mm512_mask_compressstoreu_epi32(array + writeRight - (16 - count), (__mmask16) ~mask, v);
+        writeLeft += count;
+        writeRight -= 16 - count;
+    }
+
+    T rest[48];
+    int m = 0;
+    for (int i = readLeft; i < readRight; i++) {
+        rest[m++] = array[i];
+    }
+    _mm512_storeu_si512(rest + m, savedLeft);
+    _mm512_storeu_si512(rest + m + 16, savedRight);
+    m += 32;
+    for (int i = 0; i < m; i++) {
+        if (rest[i] < pivot) {
+            array[writeLeft++] = rest[i];
+        } else {
+            array[--writeRight] = rest[i];
+        }
+    }
+    return writeLeft;
+}
+
+/** Puts the lane-wise minimum into low and the maximum into high, the floats are kept in integer vectors like in the
+ *  partition kernels
+ */
+__attribute__((target("avx2"))) inline void minMaxAvx2(__m256i &low, __m256i &high, int) {
+    __m256i minimum = _mm256_min_epi32(low, high);
+    high = _mm256_max_epi32(low, high);
+    low = minimum;
+}
+
+__attribute__((target("avx2"))) inline void minMaxAvx2(__m256i &low, __m256i &high, float) {
+    __m256 x = _mm256_castsi256_ps(low), y = _mm256_castsi256_ps(high);
+    low = _mm256_castps_si256(_mm256_min_ps(x, y));
+    high = _mm256_castps_si256(_mm256_max_ps(x, y));
+}
+
+__attribute__((target("avx2"))) inline __m256i largestAvx2(int) {
+    return _mm256_set1_epi32(INT_MAX);
+}
+
+__attribute__((target("avx2"))) inline __m256i largestAvx2(float) {
+    return _mm256_castps_si256(_mm256_set1_ps(INFINITY));
+}
+
+/** Compare-exchange of every lane i with the lane permutation[i] of the same vector, the lanes set in maxLanes keep
+ *  the maximum of the pair and the others the minimum
+ */
+template<int maxLanes, typename T>
+__attribute__((target("avx2"))) inline __m256i exchangeLanesAvx2(__m256i v, __m256i permutation, T tag) {
+    __m256i low = v, high = _mm256_permutevar8x32_epi32(v, permutation);
+    minMaxAvx2(low, high, tag);
+    return _mm256_blend_epi32(low, high, maxLanes);
+}
+
+/** Bitonic sort of the 8 lanes of a vector: the pairs, the quadruples and the whole vector are merged, each merge
+ *  starts by comparing the lanes with their mirror ( the flip ) and continues with half-cleaners
+ */
+template<typename T>
+__attribute__((target("avx2"))) inline __m256i sortLanesAvx2(__m256i v, T tag) {
+    __m256i swapPairs = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    v = exchangeLanesAvx2<0xAA>(v, swapPairs, tag);
+    v = exchangeLanesAvx2<0xCC>(v, _mm256_setr_epi32(3, 2, 1, 0, 7, 6, 5, 4), tag);
+    v = exchangeLanesAvx2<0xAA>(v, swapPairs, tag);
+    v = exchangeLanesAvx2<0xF0>(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0), tag);
+    v = exchangeLanesAvx2<0xCC>(v, _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5), tag);
+    return exchangeLanesAvx2<0xAA>(v, swapPairs, tag);
+}
+
+/** The half-cleaners inside a vector at distances 4, 2 and 1, the last steps of every merge
+ */
+template<typename T>
+__attribute__((target("avx2"))) inline __m256i mergeLanesAvx2(__m256i v, T tag) {
+    v = exchangeLanesAvx2<0xF0>(v, _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3), tag);
+    v = exchangeLanesAvx2<0xCC>(v, _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5), tag);
+    return exchangeLanesAvx2<0xAA>(v, _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6), tag);
+}
+
+/** Bitonic sort of 8 * R elements held in R registers. Every register is sorted on its own, then the groups of 2, 4,
+ *  ... registers are merged: the flip compares a register with the reversed mirror register, the half-cleaners at
+ *  distances of whole registers are plain min / max of two registers, the rest is done inside the registers.
+ */
+template<int R, typename T>
+__attribute__((target("avx2"))) inline void sortRegistersAvx2(__m256i v[], T tag) {
+    __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    for (int i = 0; i < R; i++) {
+        v[i] = sortLanesAvx2(v[i], tag);
+    }
+    for (int size = 2; size <= R; size <<= 1) {
+        for (int block = 0; block < R; block += size) {
+            for (int j = 0; j < size / 2; j++) {
+                __m256i high = _mm256_permutevar8x32_epi32(v[block + size - 1 - j], reverse);
+                minMaxAvx2(v[block + j], high, tag);
+                v[block + size - 1 - j] = _mm256_permutevar8x32_epi32(high, reverse);
+            }
+        }
+        for (int distance = size / 4; distance > 0; distance >>= 1) {
+            for (int i = 0; i < R; i++) {
+                if ((i & distance) == 0) {
+                    minMaxAvx2(v[i], v[i + distance], tag);
+                }
+            }
+        }
+        for (int i = 0; i < R; i++) {
+            v[i] = mergeLanesAvx2(v[i], tag);
+        }
+    }
+}
+
+/** Sorts array[0..n-1], n <= 8 * R, in R registers. The lanes after n are padded with the largest value, every
+ *  compare-exchange puts the minimum on the lower lane, so the padding never moves and masked stores write back
+ *  exactly n elements.
+ */
+template<int R, typename T>
+__attribute__((target("avx2"))) void registerNetworkSortAvx2(T array[], int n) {
+    __m256i v[R], masks[R];
+    __m256i padding = largestAvx2(T());
+    for (int i = 0; i < R; i++) {
+        masks[i] = _mm256_cmpgt_epi32(_mm256_set1_epi32(n - 8 * i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        v[i] = _mm256_blendv_epi8(padding, _mm256_maskload_epi32((const int *) array + 8 * i, masks[i]), masks[i]);
+    }
+    sortRegistersAvx2<R>(v, T());
+    for (int i = 0; i < R; i++) {
+        _mm256_maskstore_epi32((int *) array + 8 * i, masks[i], v[i]);
+    }
+}
+
+/** Sorts up to SMALL_NETWORK_MAX_SIZE int or float elements with a sorting network in 1, 2, 4 or 8 AVX2 registers
+ */
+template<typename T>
+void registerNetworkSort(T array[], int n) {
+    if (n <= 8) {
+        registerNetworkSortAvx2<1>(array, n);
+    } else if (n <= 16) {
+        registerNetworkSortAvx2<2>(array, n);
+    } else if (n <= 32) {
+        registerNetworkSortAvx2<4>(array, n);
+    } else {
+        registerNetworkSortAvx2<8>(array, n);
+    }
+}
+
+#endif
+
+/** Partitions array[l..r] around the given pivot value with the widest vector instructions of the machine
+ *
+ * @return  The first index of the elements >= pivot
+ */
+template<typename T>
+int partitionRangeSimd(T array[], int l, int r, T pivot) {
+#ifdef HAS_X86_SIMD
+    if (hasAvx512()) {
+        return partitionRangeAvx512(array, l, r, pivot);
+    }
+    if (hasAvx2()) {
+        return partitionRangeAvx2(array, l, r, pivot);
+    }
+#endif
+    return partitionRangeScalar(array, l, r, pivot);
+}
+
+/** Same result as partition(), with the SIMD partition, the comparisons and the stores are counted per element
+ */
+int partitionSimd(int array[], int low, int high, int pivotIndex, Operation op) {
+    op.count(7 + 2 * (high - low));
+    swap(array[pivotIndex], array[high]);
+    int pivot = array[high];
+    int boundary = partitionRangeSimd(array, low, high - 1, pivot);
+    swap(array[boundary], array[high]);
+    return boundary;
+}
+
+/** The other element types have no SIMD kernel, they are partitioned with the block partition
+ */
+template<typename T>
+int partitionSimd(T array[], int low, int high, int pivotIndex, Operation op) {
+    return partitionBlock(array, low, high, pivotIndex, op);
+}
+
+/** Insertion sort without operation counting
+ */
+template<typename T>
+void insertionSortUncounted(T array[], int low, int high) {
+    for (int i = low + 1; i <= high; i++) {
+        T key = array[i];
+        int j = i - 1;
+        while (j >= low && key < array[j]) {
+            array[j + 1] = array[j];
+            j--;
+        }
+        array[j + 1] = key;
+    }
+}
+
+/** Sorts the small partitions of simdQuickSort, with the in-register sorting network if AVX2 is available
+ */
+template<typename T>
+void smallSort(T array[], int low, int high) {
+#ifdef HAS_X86_SIMD
+    if (hasAvx2() && high - low + 1 <= SMALL_NETWORK_MAX_SIZE) {
+        registerNetworkSort(array + low, high - low + 1);
+        return;
+    }
+#endif
+    insertionSortUncounted(array, low, high);
+}
+
+/** Quick-Sort with the SIMD partition for int and float arrays, without operation counting
+ */
+template<typename T>
+void simdQuickSort(T array[], int low, int high) {
+    int cutoff = sortParameters.insertionSortCutoff;
+#ifdef HAS_X86_SIMD
+    cutoff = hasAvx2() ? sortParameters.networkSortCutoff : cutoff;
+#endif
+    while (high - low + 1 >= cutoff) {
+        int mid = low + (high - low) / 2;
+        if (array[mid] < array[low]) {
+            swap(array[mid], array[low]);
+        }
+        if (array[high] < array[mid]) {
+            swap(array[high], array[mid]);
+            if (array[mid] < array[low]) {
+                swap(array[mid], array[low]);
+            }
+        }
+        swap(array[mid], array[high]);
+        T pivot = array[high];
+        int boundary = partitionRangeSimd(array, low, high - 1, pivot);
+        swap(array[boundary], array[high]);
+        if (boundary - low < high - boundary) {
+            simdQuickSort(array, low, boundary - 1);
+            low = boundary + 1;
+        } else {
+            simdQuickSort(array, boundary + 1, high);
+            high = boundary - 1;
+        }
+    }
+    smallSort(array, low, high);
+}
+
+/** Sorts array[low..high] with the given partition strategy, the pivot is the median of three
+ *
+ * @param array
+ * @param low
+ * @param high
+ * @param strategy
+ * @param op
+ */
+template<typename T>
+void quickSortStrategy(T array[], int low, int high, PartitionStrategy strategy, Operation op) {
+    op.count();
+    if (low >= high) {
+        return;
+    }
+    switch (strategy) {
+        case LOMUTO_PARTITION: {
+            int pivotIndex = medianOfThree(array, low, low + (high - low) / 2, high, op);
+            int pivot = partition(array, low, high, pivotIndex, op);
+            quickSortStrategy(array, low, pivot - 1, strategy, op);
+            quickSortStrategy(array, pivot + 1, high, strategy, op);
+            break;
+        }
+        case THREE_WAY_PARTITION: {
+            int lt, gt;
+            int pivotIndex = medianOfThree(array, low, low + (high - low) / 2, high, op);
+            partitionThreeWay(array, low, high, pivotIndex, lt, gt, op);
+            quickSortStrategy(array, low, lt - 1, strategy, op);
+            quickSortStrategy(array, gt + 1, high, strategy, op);
+            break;
+        }
+        case DUAL_PIVOT_PARTITION: {
+            int lp, rp;
+            partitionDualPivot(array, low, high, lp, rp, op);
+            quickSortStrategy(array, low, lp - 1, strategy, op);
+            quickSortStrategy(array, rp + 1, high, strategy, op);
+            T p = array[lp], q = array[rp];
+            op.count();
+            if (p == q) {
+                break;
+            }
+            // the copies of the pivots are moved out of the middle part, so it shrinks even with few distinct values
+            int l = lp + 1, g = rp - 1;
+            for (int k = l; k <= g; k++) {
+                op.count();
+                if (array[k] == p) {
+                    op.count(3);
+                    swap(array[k], array[l++]);
+                } else {
+                    op.count();
+                    if (array[k] == q) {
+                        op.count();
+                        while (array[g] == q && k < g) {
+                            op.count();
+                            g--;
+                        }
+                        op.count(4);
+                        swap(array[k], array[g--]);
+                        if (array[k] == p) {
+                            op.count(3);
+                            swap(array[k], array[l++]);
+                        }
+                    }
+                }
+            }
+            quickSortStrategy(array, l, g, strategy, op);
+            break;
+        }
+        case BLOCK_PARTITION: {
+            int pivotIndex = medianOfThree(array, low, low + (high - low) / 2, high, op);
+            int pivot = partitionBlock(array, low, high, pivotIndex, op);
+            quickSortStrategy(array, low, pivot - 1, strategy, op);
+            quickSortStrategy(array, pivot + 1, high, strategy, op);
+            break;
+        }
+        case SIMD_PARTITION: {
+            int pivotIndex = medianOfThree(array, low, low + (high - low) / 2, high, op);
+            int pivot = partitionSimd(array, low, high, pivotIndex, op);
+            quickSortStrategy(array, low, pivot - 1, strategy, op);
+            quickSortStrategy(array, pivot + 1, high, strategy, op);
+            break;
+        }
+    }
+}
+
+template<typename T>
+void introSort(T array[], int low, int high, int depthLimit, Operation op) {
+    op.count();
+    if (high - low + 1 < sortParameters.insertionSortCutoff) {
+        insertionSort(array, low, high, op);
+        return;
+    }
+    if (depthLimit == 0) {
+        heapSort(array + low, high - low + 1, op);
+        return;
+    }
+    int pivotIndex = medianOfThree(array, low, low + (high - low) / 2, high, op);
+    int pivot = partition(array, low, high, pivotIndex, op);
+    introSort(array, low, pivot - 1, depthLimit - 1, op);
+    introSort(array, pivot + 1, high, depthLimit - 1, op);
+}
+
+/** Sorts the array in increasing order
+ *  Method implemented: Intro-Sort, Quick-Sort which falls back to Heap-Sort after 2 * log2(n) levels
+ *
+ * @param array
+ * @param n         Size of the array
+ * @param op
+ */
+template<typename T>
+void introSort(T array[], int n, Operation op) {
+    int depthLimit = 0;
+    for (int i = n; i > 1; i >>= 1) {
+        depthLimit += 2;
+    }
+    introSort(array, 0, n - 1, depthLimit, op);
+}
+
+int getParentIndex(int i) {
+    return (i - 1) / 2;
+}
+
+int getLeftChildIndex(int i) {
+    int key = i << 1;
+    return key + 1;
+}
+
+int getRightChildIndex(int i) {
+    int key = i << 1;
+    return key + 2;
+}
+
+/** Moves the element at i down to its place in the heap a[0..n-1] without recursion. The element is carried as a
+ *  hole and written only once at the end, so every level costs one move instead of a swap.
+ *
+ * @param before    before(x, y) is true if x has to be closer to the root than y, greater<T>() for a max-heap and
+ *                  less<T>() for a min-heap
+ */
+template<typename T, typename Compare>
+void siftDown(T a[], int i, int n, Compare before, Operation op) {
+    op.count();
+    T x = a[i];
+    int child = getLeftChildIndex(i);
+    while (child < n) {
+        int rightChildIndex = getRightChildIndex(i);
+        if (rightChildIndex < n) {
+            op.count();
+            if (before(a[rightChildIndex], a[child])) {
+                child = rightChildIndex;
+            }
+        }
+        op.count();
+        if (!before(a[child], x)) {
+            break;
+        }
+        op.count();
+        a[i] = a[child];
+        i = child;
+        child = getLeftChildIndex(i);
+    }
+    op.count();
+    a[i] = x;
+}
+
+/** Moves the element at i up to its place in the heap, with a hole like siftDown
+ */
+template<typename T, typename Compare>
+void siftUp(T a[], int i, Compare before, Operation op) {
+    op.count();
+    T x = a[i];
+    while (i > 0) {
+        int parentIndex = getParentIndex(i);
+        op.count();
+        if (!before(x, a[parentIndex])) {
+            break;
+        }
+        op.count();
+        a[i] = a[parentIndex];
+        i = parentIndex;
+    }
+    op.count();
+    a[i] = x;
+}
+
+template<typename T>
+void buildMaxHeapBottomUp(T a[], int n, Operation op) {
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        siftDown(a, i, n, greater<T>(), op);
+    }
+}
+
+template<typename T>
+void heapSort(T a[], int n, Operation op) {
+    buildMaxHeapBottomUp(a, n, op);
+    for (int i = n - 1; i > 0; i--) {
+        op.count(3);
+        swap(a[0], a[i]);
+        n--;
+        siftDown(a, 0, n, greater<T>(), op);
+    }
+}
+
+/** Sift-down of Floyd's bottom-up Heap-Sort: the element at i is taken out and the hole goes down along the larger
+ *  children to a leaf ( one comparison per level instead of two ), then the element climbs back up from the leaf to
+ *  its place, which is usually only a level or two. The elements are moved into the hole instead of being swapped.
+ */
+void siftDownBottomUp(int a[], int i, int n, Operation op) {
+    op.count();
+    int x = a[i];
+    int hole = i;
+    int child = getLeftChildIndex(hole);
+    while (child < n) {
+        if (child + 1 < n) {
+            op.count();
+            if (a[child + 1] > a[child]) {
+                child++;
+            }
+        }
+        op.count();
+        a[hole] = a[child];
+        hole = child;
+        child = getLeftChildIndex(hole);
+    }
+    while (hole > i) {
+        int parent = getParentIndex(hole);
+        op.count();
+        if (!(x > a[parent])) {
+            break;
+        }
+        op.count();
+        a[hole] = a[parent];
+        hole = parent;
+    }
+    op.count();
+    a[hole] = x;
+}
+
+/** Sorts the array in increasing order
+ *  Method implemented: Floyd's bottom-up Heap-Sort
+ *
+ * @param a
+ * @param n     Size of the array
+ * @param op
+ */
+void bottomUpHeapSort(int a[], int n, Operation op) {
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        siftDownBottomUp(a, i, n, op);
+    }
+    for (int i = n - 1; i > 0; i--) {
+        op.count(3);
+        swap(a[0], a[i]);
+        siftDownBottomUp(a, 0, i, op);
+    }
+}
+
+void printArray(int array[], int n) {
+    for (int i = 0; i < n; i++) {
+        cout << array[i] << " ";
+    }
+    cout << endl;
+}
+
+void worstCase(int n) {
+    int testArray[MAX_SIZE];
+    FillRandomArray(testArray, n, 1, 10000, false, 2);
+    int a[MAX_SIZE];
+    int b[MAX_SIZE];
+    CopyArray(a, testArray, MAX_SIZE);
+    CopyArray(b, testArray, MAX_SIZE);
+    Operation worstCaseQuickSort = profiler.createOperation("Worst Quick Sort", n);
+    Operation worstCaseHeapSort = profiler.createOperation("Worst Heap Sort", n);
+    Operation worstCaseIntroSort = profiler.createOperation("Worst Intro Sort", n);
+    Operation worstCaseIterative = profiler.createOperation("Worst Iterative Quick Sort", n);
+    int c[MAX_SIZE];
+    CopyArray(c, testArray, n);
+    quickSortIterative<LastPivot>(c, 0, n - 1, worstCaseIterative);
+    quickSort(a, 0, n - 1, worstCaseQuickSort);
+    heapSort(b, n, worstCaseHeapSort);
+    introSort(testArray, n, worstCaseIntroSort);
+}
+
+void bestCase(int n) {
+    int testArray[MAX_SIZE];
+    FillRandomArray(testArray, n, 1, 10000, false, 1);
+    int a[MAX_SIZE];
+    int b[MAX_SIZE];
+    CopyArray(a, testArray, MAX_SIZE);
+    CopyArray(b, testArray, MAX_SIZE);
+    Operation bestCaseQuickSort = profiler.createOperation("Best Quick Sort", n);
+    Operation bestCaseHeapSort = profiler.createOperation("Best Heap Sort", n);
+    quickSortBestCase(testArray, 0, n - 1, bestCaseQuickSort);
+    heapSort(b, n, bestCaseHeapSort);
+
+}
+
+void averageCase(int n) {
+    int testArray[MAX_SIZE];
+    FillRandomArray(testArray, n, 1, 10000, false, 0);
+    int a[MAX_SIZE];
+    int b[MAX_SIZE];
+    CopyArray(a, testArray, MAX_SIZE);
+    CopyArray(b, testArray, MAX_SIZE);
+    Operation averageCaseQuickSort = profiler.createOperation("Average Quick Sort", n);
+    Operation averageCaseHeapSort = profiler.createOperation("Average Heap Sort", n);
+    Operation averageCaseSampleSort = profiler.createOperation("Average Sample Sort", n);
+    Operation averageCaseIntroSort = profiler.createOperation("Average Intro Sort", n);
+    Operation averageCaseBottomUpHeapSort = profiler.createOperation("Average Bottom-Up Heap Sort", n);
+    int c[MAX_SIZE];
+    CopyArray(c, testArray, n);
+    bottomUpHeapSort(c, n, averageCaseBottomUpHeapSort);
+    static ThreadPool pool(max(1, (int) thread::hardware_concurrency()));
+    quickSortRandom(testArray, 0, n - 1, averageCaseQuickSort);
+    heapSort(b, n, averageCaseHeapSort);
+    CopyArray(b, a, n);
+    sampleSort(a, n, pool, averageCaseSampleSort);
+    introSort(b, n, averageCaseIntroSort);
+}
+
+template<typename T>
+void sortTwo(T array[], int a, int b, Operation op) {
+    op.count();
+    if (array[b] < array[a]) {
+        op.count(3);
+        swap(array[a], array[b]);
+    }
+}
+
+template<typename T>
+void sortThree(T array[], int a, int b, int c, Operation op) {
+    sortTwo(array, a, b, op);
+    sortTwo(array, b, c, op);
+    sortTwo(array, a, b, op);
+}
+
+/** Insertion sort which gives up after PARTIAL_INSERTION_LIMIT moves
+ *
+ * @return  true if array[low..high] got sorted
+ */
+template<typename T>
+bool partialInsertionSort(T array[], int low, int high, Operation op) {
+    int moves = 0;
+    for (int i = low + 1; i <= high; i++) {
+        T key = array[i];
+        int j = i - 1;
+        op.count(2);
+        while (j >= low && array[j] > key) {
+            array[j + 1] = array[j];
+            j--;
+            op.count(2);
+        }
+        array[j + 1] = key;
+        moves += i - 1 - j;
+        if (moves > PARTIAL_INSERTION_LIMIT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Partitions array[low+1..high] around the pivot array[low], the elements equal to the pivot go to the right
+ *
+ * @param alreadyPartitioned    Set if no element had to be swapped
+ * @return                      The final position of the pivot
+ */
+template<typename T>
+int partitionRight(T array[], int low, int high, bool &alreadyPartitioned, Operation op) {
+    T pivot = array[low];
+    int first = low + 1, last = high;
+    op.count();
+    while (first <= last && array[first] < pivot) {
+        first++;
+        op.count();
+    }
+    op.count();
+    while (first <= last && !(array[last] < pivot)) {
+        last--;
+        op.count();
+    }
+    alreadyPartitioned = first > last;
+    if (!alreadyPartitioned) {
+        op.count(3);
+        swap(array[first], array[last]);
+        first = blockPartitionRange(array, first + 1, last - 1, pivot, op);
+    }
+    op.count(3);
+    swap(array[low], array[first - 1]);
+    return first - 1;
+}
+
+/** Partitions array[low+1..high] around the pivot array[low], the elements equal to the pivot go to the left
+ *
+ * @return  The final position of the pivot
+ */
+template<typename T>
+int partitionLeft(T array[], int low, int high, Operation op) {
+    T pivot = array[low];
+    int i = low;
+    for (int j = low + 1; j <= high; j++) {
+        op.count();
+        if (!(pivot < array[j])) {
+            op.count(3);
+            swap(array[++i], array[j]);
+        }
+    }
+    op.count(3);
+    swap(array[low], array[i]);
+    return i;
+}
+
+template<typename T>
+void pdqSort(T array[], int low, int high, int badAllowed, bool leftmost, Operation op) {
+    while (true) {
+        int n = high - low + 1;
+        op.count();
+        if (n < sortParameters.insertionSortCutoff) {
+            insertionSort(array, low, high, op);
+            return;
+        }
+
+        int mid = low + n / 2;
+        if (n > sortParameters.nintherThreshold) {
+            sortThree(array, low, mid, high, op);
+            sortThree(array, low + 1, mid - 1, high - 1, op);
+            sortThree(array, low + 2, mid + 1, high - 2, op);
+            sortThree(array, mid - 1, mid, mid + 1, op);
+            op.count(3);
+            swap(array[low], array[mid]);
+        } else {
+            sortThree(array, mid, low, high, op);
+        }
+
+        // the previous pivot is not smaller, so the elements equal to it are already on their place
+        op.count();
+        if (!leftmost && !(array[low - 1] < array[low])) {
+            low = partitionLeft(array, low, high, op) + 1;
+            continue;
+        }
+
+        bool alreadyPartitioned;
+        int pivot = partitionRight(array, low, high, alreadyPartitioned, op);
+        int leftSize = pivot - low, rightSize = high - pivot;
+        if (leftSize < n / 8 || rightSize < n / 8) {
+            if (--badAllowed == 0) {
+                heapSort(array + low, n, op);
+                return;
+            }
+            op.count(6);
+            if (leftSize >= sortParameters.insertionSortCutoff) {
+                swap(array[low], array[low + leftSize / 4]);
+                swap(array[pivot - 1], array[pivot - leftSize / 4]);
+            }
+            if (rightSize >= sortParameters.insertionSortCutoff) {
+                swap(array[pivot + 1], array[pivot + 1 + rightSize / 4]);
+                swap(array[high], array[high - rightSize / 4]);
+            }
+        } else if (alreadyPartitioned && partialInsertionSort(array, low, pivot - 1, op) &&
+                   partialInsertionSort(array, pivot + 1, high, op)) {
+            return;
+        }
+
+        pdqSort(array, low, pivot - 1, badAllowed, leftmost, op);
+        low = pivot + 1;
+        leftmost = false;
+    }
+}
+
+/** Sorts the array in increasing order
+ *  Method implemented: Pattern-Defeating Quick-Sort
+ *
+ * @param array
+ * @param n         Size of the array
+ * @param op
+ */
+template<typename T>
+void pdqSort(T array[], int n, Operation op) {
+    int badAllowed = 1;
+    for (int i = n; i > 1; i >>= 1) {
+        badAllowed++;
+    }
+    pdqSort(array, 0, n - 1, badAllowed, true, op);
+}
+
+/** Partitions array[low..high] with every thread of the pool, the result is the same as the one of partition()
+ *
+ * @param buffer    Scratch space, at least as large as the array
+ */
+int parallelPartition(int array[], int low, int high, int pivotIndex, int buffer[], WorkStealingPool &pool,
+                      Operation op) {
+    op.count(4);
+    swap(array[pivotIndex], array[high]);
+    int pivot = array[high];
+    int n = high - low, nrStripes = pool.size();
+    int stripe = (n + nrStripes - 1) / nrStripes;
+    vector<int> smaller(nrStripes + 1, 0), larger(nrStripes + 1, 0);
+    atomic<int> pending(0);
+    for (int t = 0; t < nrStripes; t++) {
+        pool.spawn(pending, [&, t] {
+            int from = low + min(n, t * stripe), to = low + min(n, (t + 1) * stripe);
+            int count = 0;
+            for (int i = from; i < to; i++) {
+                count += array[i] < pivot;
+            }
+            smaller[t + 1] = count;
+            larger[t + 1] = to - from - count;
+        });
+    }
+    pool.wait(pending);
+    op.count(n);
+    for (int t = 0; t < nrStripes; t++) {
+        smaller[t + 1] += smaller[t];
+        larger[t + 1] += larger[t];
+    }
+
+    int boundary = low + smaller[nrStripes];
+    for (int t = 0; t < nrStripes; t++) {
+        pool.spawn(pending, [&, t] {
+            int from = low + min(n, t * stripe), to = low + min(n, (t + 1) * stripe);
+            int left = low + smaller[t], right = boundary + 1 + larger[t];
+            for (int i = from; i < to; i++) {
+                if (array[i] < pivot) {
+                    buffer[left++] = array[i];
+                } else {
+                    buffer[right++] = array[i];
+                }
+            }
+        });
+    }
+    pool.wait(pending);
+    op.count(2 * n);
+    buffer[boundary] = pivot;
+    for (int t = 0; t < nrStripes; t++) {
+        pool.spawn(pending, [&, t] {
+            int from = low + min(n + 1, t * stripe), to = low + min(n + 1, (t + 1) * stripe);
+            if (t == nrStripes - 1) {
+                to = high + 1;
+            }
+            copy(buffer + from, buffer + to, array + from);
+        });
+    }
+    pool.wait(pending);
+    op.count(n + 1);
+    return boundary;
+}
+
+void parallelQuickSortTask(int array[], int low, int high, int depthLimit, int buffer[], WorkStealingPool &pool,
+                           atomic<int> &pending, atomic<long long> &operations) {
+    Profiler local;
+    Operation op = local.createOperation("Task", 0);
+    while (high - low + 1 > sortParameters.parallelGrainSize && depthLimit > 0) {
+        int pivotIndex = medianOfThree(array, low, low + (high - low) / 2, high, op);
+        int pivot;
+        if (high - low + 1 >= PARALLEL_PARTITION_SIZE && pool.size() > 1) {
+            pivot = parallelPartition(array, low, high, pivotIndex, buffer, pool, op);
+        } else {
+            pivot = partitionBlock(array, low, high, pivotIndex, op);
+        }
+        depthLimit--;
+        int left = low, right = pivot - 1;
+        if (right - left + 1 > sortParameters.parallelGrainSize) {
+            pool.spawn(pending, [=, &pool, &pending, &operations] {
+                parallelQuickSortTask(array, left, right, depthLimit, buffer, pool, pending, operations);
+            });
+        } else {
+            pdqSort(array + left, right - left + 1, op);
+        }
+        low = pivot + 1;
+    }
+    // pdqsort takes care of the bad cases below the depth limit too
+    pdqSort(array + low, high - low + 1, op);
+    operations += op.get();
+}
+
+/** Sorts the array in increasing order on the threads of the given pool
+ *  Method implemented: Task parallel Quick-Sort on a work-stealing scheduler, every task counts its operations in
+ *  its own Profiler, they are added to op at the end
+ *
+ * @param array
+ * @param n         Size of the array
+ * @param pool
+ * @param op
+ */
+void parallelQuickSort(int array[], int n, WorkStealingPool &pool, Operation op) {
+    int depthLimit = 0;
+    for (int i = n; i > 1; i >>= 1) {
+        depthLimit += 2;
+    }
+    vector<int> buffer(n >= PARALLEL_PARTITION_SIZE && pool.size() > 1 ? n : 0);
+    atomic<int> pending(0);
+    atomic<long long> operations(0);
+    parallelQuickSortTask(array, 0, n - 1, depthLimit, buffer.data(), pool, pending, operations);
+    pool.wait(pending);
+    op.count((int) operations);
+}
+
+void fillInput(int array[], int n, InputShape shape) {
+    switch (shape) {
+        case RANDOM_INPUT:
+            FillRandomArray(array, n, 1, 10000, false, 0);
+            break;
+        case ASCENDING_INPUT:
+            FillRandomArray(array, n, 1, 10000, false, 1);
+            break;
+        case DESCENDING_INPUT:
+            FillRandomArray(array, n, 1, 10000, false, 2);
+            break;
+        case FEW_UNIQUE_INPUT:
+            FillRandomArray(array, n, 1, FEW_UNIQUE_VALUES, false, 0);
+            break;
+        case ALL_EQUAL_INPUT:
+            fill(array, array + n, 1);
+            break;
+        case ORGAN_PIPE_INPUT:
+            FillRandomArray(array, n, 1, 10000, false, 1);
+            reverse(array + n / 2, array + n);
+            break;
+    }
+}
+
+/** Runs pdqsort and std::sort on every input shape, the time ( microseconds ) is recorded in the
+ *  "PDQ <shape> Time" and "std::sort <shape> Time" series, the operations of pdqsort in "PDQ <shape>"
+ */
+void pdqCase(int n) {
+    int testArray[MAX_SIZE];
+    int a[MAX_SIZE];
+    for (int shape = 0; shape < NR_INPUT_SHAPES; shape++) {
+        string name = inputShapeNames[shape];
+        fillInput(testArray, n, (InputShape) shape);
+
+        CopyArray(a, testArray, n);
+        Profiler local;
+        Operation dummy = local.createOperation("Dummy", 0);
+        auto start = chrono::steady_clock::now();
+        pdqSort(a, n, dummy);
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation(("PDQ " + name + " Time").c_str(), n).count((int) elapsed.count());
+
+        CopyArray(a, testArray, n);
+        start = chrono::steady_clock::now();
+        sort(a, a + n);
+        elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation(("std::sort " + name + " Time").c_str(), n).count((int) elapsed.count());
+
+        CopyArray(a, testArray, n);
+        Operation op = profiler.createOperation(("PDQ " + name).c_str(), n);
+        pdqSort(a, n, op);
+    }
+}
+
+void createPdqGroups() {
+    for (int shape = 0; shape < NR_INPUT_SHAPES; shape++) {
+        string name = inputShapeNames[shape];
+        profiler.createGroup(("PDQ " + name + " vs std::sort").c_str(), ("PDQ " + name + " Time").c_str(),
+                             ("std::sort " + name + " Time").c_str());
+    }
+    profiler.createGroup("PDQ Operations", "PDQ Random", "PDQ Ascending", "PDQ Descending", "PDQ Few Unique",
+                         "PDQ All Equal", "PDQ Organ Pipe");
+}
+
+template<typename PivotPolicy>
+void pivotPolicyCase(const int testArray[], int n, const string &series) {
+    int a[MAX_SIZE];
+    CopyArray(a, (int *) testArray, n);
+    Operation op = profiler.createOperation(series.c_str(), n);
+    quickSortPolicy<PivotPolicy>(a, 0, n - 1, op);
+}
+
+/** Sorts every input shape with every pivot policy, the operations are recorded in "Pivot <shape> <policy>"
+ */
+void pivotCase(int n) {
+    int testArray[MAX_SIZE];
+    for (int shape = 0; shape < NR_INPUT_SHAPES; shape++) {
+        fillInput(testArray, n, (InputShape) shape);
+        string name = string("Pivot ") + inputShapeNames[shape] + " ";
+        pivotPolicyCase<LastPivot>(testArray, n, name + pivotPolicyNames[0]);
+        pivotPolicyCase<MiddlePivot>(testArray, n, name + pivotPolicyNames[1]);
+        pivotPolicyCase<RandomPivot>(testArray, n, name + pivotPolicyNames[2]);
+        pivotPolicyCase<MedianOfThreePivot>(testArray, n, name + pivotPolicyNames[3]);
+        pivotPolicyCase<NintherPivot>(testArray, n, name + pivotPolicyNames[4]);
+        pivotPolicyCase<MedianOfMediansPivot>(testArray, n, name + pivotPolicyNames[5]);
+    }
+}
+
+/** McIlroy's adversary, the values of the keys are decided while they are compared
+ */
+class AntiQsortAdversary {
+public:
+    explicit AntiQsortAdversary(int n) : values(n, n), gas(n), nrSolid(0), candidate(-1) {
+    }
+
+    int compare(int x, int y) {
+        if (values[x] == gas && values[y] == gas) {
+            freeze(x == candidate ? x : y);
+        }
+        if (values[x] == gas) {
+            candidate = x;
+        } else if (values[y] == gas) {
+            candidate = y;
+        }
+        return values[x] - values[y];
+    }
+
+    /** Freezes the remaining gas keys, the result is the killer input, its ith element is the value of the ith key
+     */
+    vector<int> killerInput() {
+        for (int x = 0; x < (int) values.size(); x++) {
+            if (values[x] == gas) {
+                freeze(x);
+            }
+        }
+        return values;
+    }
+
+private:
+    vector<int> values;
+    int gas;
+    int nrSolid;
+    int candidate;
+
+    void freeze(int x) {
+        values[x] = nrSolid++;
+    }
+};
+
+/** Key of the adversary, the comparisons are answered by the adversary which is currently running
+ */
+struct AdversaryKey {
+    int id;
+};
+
+AntiQsortAdversary *currentAdversary = NULL;
+
+bool operator<(AdversaryKey a, AdversaryKey b) {
+    return currentAdversary->compare(a.id, b.id) < 0;
+}
+
+bool operator>(AdversaryKey a, AdversaryKey b) {
+    return currentAdversary->compare(a.id, b.id) > 0;
+}
+
+bool operator==(AdversaryKey a, AdversaryKey b) {
+    return currentAdversary->compare(a.id, b.id) == 0;
+}
+
+/** Runs a sort against the adversary
+ *
+ * @param n     Size of the input
+ * @param sort  sort(array, n, op) sorts ( or selects in ) the array, it is called with AdversaryKey and int arrays
+ * @param op    Counts the operations of the sort on the adversary
+ * @return      The killer input for the sort
+ */
+template<typename Sort>
+vector<int> antiQsort(int n, Sort sort, Operation op) {
+    AntiQsortAdversary adversary(n);
+    currentAdversary = &adversary;
+    vector<AdversaryKey> keys(n);
+    for (int i = 0; i < n; i++) {
+        keys[i].id = i;
+    }
+    sort(keys.data(), n, op);
+    currentAdversary = NULL;
+    return adversary.killerInput();
+}
+
+/** Attacks the sort with the adversary and then sorts the killer input again as a plain int array, the operations are
+ *  recorded in the "Antiqsort <name>" and "Replay <name>" series. The replay only matches the attack if the sort is
+ *  deterministic, the random pivots are drawn again.
+ */
+template<typename Sort>
+void antiQsortCase(int n, const string &name, Sort sort) {
+    vector<int> killer = antiQsort(n, sort, profiler.createOperation(("Antiqsort " + name).c_str(), n));
+    sort(killer.data(), n, profiler.createOperation(("Replay " + name).c_str(), n));
+}
+
+template<typename PivotPolicy>
+void antiQsortPolicyCase(int n, const string &name) {
+    antiQsortCase(n, name, [](auto array, int size, Operation op) {
+        quickSortPolicy<PivotPolicy>(array, 0, size - 1, op);
+    });
+}
+
+template<PartitionStrategy strategy>
+void antiQsortStrategyCase(int n) {
+    antiQsortCase(n, partitionStrategyNames[strategy], [](auto array, int size, Operation op) {
+        quickSortStrategy(array, 0, size - 1, strategy, op);
+    });
+}
+
+void antiQsortCase(int n) {
+    antiQsortPolicyCase<LastPivot>(n, pivotPolicyNames[0]);
+    antiQsortPolicyCase<MiddlePivot>(n, pivotPolicyNames[1]);
+    antiQsortPolicyCase<RandomPivot>(n, pivotPolicyNames[2]);
+    antiQsortPolicyCase<MedianOfThreePivot>(n, pivotPolicyNames[3]);
+    antiQsortPolicyCase<NintherPivot>(n, pivotPolicyNames[4]);
+    antiQsortPolicyCase<MedianOfMediansPivot>(n, pivotPolicyNames[5]);
+    antiQsortStrategyCase<THREE_WAY_PARTITION>(n);
+    antiQsortStrategyCase<DUAL_PIVOT_PARTITION>(n);
+    antiQsortStrategyCase<BLOCK_PARTITION>(n);
+    antiQsortCase(n, "PDQ-Sort", [](auto array, int size, Operation op) {
+        pdqSort(array, size, op);
+    });
+    antiQsortCase(n, "Intro-Sort", [](auto array, int size, Operation op) {
+        introSort(array, size, op);
+    });
+    antiQsortCase(n, "Intro-Select", [](auto array, int size, Operation op) {
+        introSelect(array, 0, size - 1, size / 2, op);
+    });
+    antiQsortCase(n, "Floyd-Rivest", [](auto array, int size, Operation op) {
+        floydRivestSelect(array, 0, size - 1, size / 2, op);
+    });
+}
+
+void createAntiQsortGroups() {
+    profiler.createGroup("Antiqsort Simple Pivots", "Antiqsort Last", "Replay Last", "Antiqsort Middle",
+                         "Replay Middle", "Antiqsort Random", "Replay Random");
+    profiler.createGroup("Antiqsort Median Pivots", "Antiqsort Median-of-3", "Replay Median-of-3", "Antiqsort Ninther",
+                         "Replay Ninther", "Antiqsort Median-of-Medians", "Replay Median-of-Medians");
+    profiler.createGroup("Antiqsort Partition Strategies", "Antiqsort Three-Way", "Replay Three-Way",
+                         "Antiqsort Dual-Pivot", "Replay Dual-Pivot", "Antiqsort Block", "Replay Block");
+    profiler.createGroup("Antiqsort Hybrid Sorts", "Antiqsort PDQ-Sort", "Replay PDQ-Sort", "Antiqsort Intro-Sort",
+                         "Replay Intro-Sort");
+    profiler.createGroup("Antiqsort Selection", "Antiqsort Intro-Select", "Replay Intro-Select",
+                         "Antiqsort Floyd-Rivest", "Replay Floyd-Rivest");
+}
+
+void createPivotGroups() {
+    for (int shape = 0; shape < NR_INPUT_SHAPES; shape++) {
+        string name = string("Pivot ") + inputShapeNames[shape];
+        string series[NR_PIVOT_POLICIES];
+        for (int policy = 0; policy < NR_PIVOT_POLICIES; policy++) {
+            series[policy] = name + " " + pivotPolicyNames[policy];
+        }
+        profiler.createGroup(name.c_str(), series[0].c_str(), series[1].c_str(), series[2].c_str(),
+                             series[3].c_str(), series[4].c_str(), series[5].c_str());
+    }
+}
+
+/** Runs every partition strategy on the same array, the operations and the time ( microseconds ) are recorded in the
+ *  "<name> <strategy>" and "<name> <strategy> Time" series
+ */
+void partitionCase(const int testArray[], int n, const string &name) {
+    int a[MAX_SIZE];
+    for (int s = 0; s < NR_PARTITION_STRATEGIES; s++) {
+        CopyArray(a, (int *) testArray, n);
+        string series = name + " " + partitionStrategyNames[s];
+        Operation op = profiler.createOperation(series.c_str(), n);
+        auto start = chrono::steady_clock::now();
+        quickSortStrategy(a, 0, n - 1, (PartitionStrategy) s, op);
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation((series + " Time").c_str(), n).count((int) elapsed.count());
+    }
+}
+
+void fewUniqueCase(int n) {
+    int testArray[MAX_SIZE];
+    FillRandomArray(testArray, n, 1, FEW_UNIQUE_VALUES, false, 0);
+    partitionCase(testArray, n, "Few Unique");
+}
+
+void allEqualCase(int n) {
+    int testArray[MAX_SIZE];
+    fill(testArray, testArray + n, 1);
+    partitionCase(testArray, n, "All Equal");
+}
+
+void createPartitionGroups(const string &name) {
+    string series[NR_PARTITION_STRATEGIES], times[NR_PARTITION_STRATEGIES];
+    for (int s = 0; s < NR_PARTITION_STRATEGIES; s++) {
+        series[s] = name + " " + partitionStrategyNames[s];
+        times[s] = series[s] + " Time";
+    }
+    profiler.createGroup(name.c_str(), series[0].c_str(), series[1].c_str(), series[2].c_str(), series[3].c_str(),
+                         series[4].c_str());
+    profiler.createGroup((name + " Time").c_str(), times[0].c_str(), times[1].c_str(), times[2].c_str(),
+                         times[3].c_str(), times[4].c_str());
+}
+
+/** Hardware branch miss counter of the calling thread ( Linux perf events )
+ *  available() is false if the kernel or the machine doesn't allow it, then stop() always returns 0
+ */
+class BranchMissCounter {
+public:
+    BranchMissCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        fd = (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+    }
+
+    ~BranchMissCounter() {
+#ifdef __linux__
+        if (fd != -1) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool available() const {
+        return fd != -1;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+        long long misses = 0;
+#ifdef __linux__
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) {
+                misses = 0;
+            }
+        }
+#endif
+        return misses;
+    }
+
+private:
+    int fd;
+};
+
+/** Sorts a random array with the Lomuto and the Block partition, the branch misses and the running time
+ *  ( microseconds ) are recorded
+ */
+void partitionBranchCase(int n, BranchMissCounter &counter) {
+    int testArray[MAX_SIZE];
+    int a[MAX_SIZE];
+    FillRandomArray(testArray, n, 1, 10000, false, 0);
+    PartitionStrategy strategies[2] = {LOMUTO_PARTITION, BLOCK_PARTITION};
+    for (PartitionStrategy strategy : strategies) {
+        CopyArray(a, testArray, n);
+        string name = partitionStrategyNames[strategy];
+        Profiler local;
+        Operation dummy = local.createOperation("Dummy", 0);
+        auto start = chrono::steady_clock::now();
+        counter.start();
+        quickSortStrategy(a, 0, n - 1, strategy, dummy);
+        long long misses = counter.stop();
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation((name + " Branch Misses").c_str(), n).count((int) misses);
+        profiler.createOperation((name + " Partition Time").c_str(), n).count((int) elapsed.count());
+    }
+}
+
+/** Measures the running time ( microseconds ) of the Sample-Sort on SCALING_SIZE random elements for 1, 2, 4, ...
+ *  threads, up to the number of hardware threads, the single threaded Quick-Sort is the baseline
+ */
+void runSampleSortScaling() {
+    int maxThreads = max(1, (int) thread::hardware_concurrency());
+    vector<int> testArray(SCALING_SIZE);
+    vector<int> a(SCALING_SIZE);
+    FillRandomArray(testArray.data(), SCALING_SIZE, 1, 1000000000, false, 0);
+    for (int threads = 1; threads <= maxThreads; threads = threads < maxThreads ? min(2 * threads, maxThreads) : threads + 1) {
+        Profiler local;
+        Operation dummy = local.createOperation("Dummy", 0);
+
+        a = testArray;
+        auto start = chrono::steady_clock::now();
+        quickSortRandom(a.data(), 0, SCALING_SIZE - 1, dummy);
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation("Quick Sort Time", threads).count((int) elapsed.count());
+
+        a = testArray;
+        ThreadPool pool(threads);
+        start = chrono::steady_clock::now();
+        sampleSort(a.data(), SCALING_SIZE, pool, dummy);
+        elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation("Sample Sort Time", threads).count((int) elapsed.count());
+    }
+    profiler.createGroup("Sample Sort Scaling", "Sample Sort Time", "Quick Sort Time");
+}
+
+/** Measures the running time ( microseconds ) of the work-stealing Quick-Sort for 1, 2, 4, ... threads, up to the
+ *  number of hardware threads: with SCALING_SIZE elements ( strong scaling ) and with WEAK_SCALING_SIZE elements per
+ *  thread ( weak scaling ), the speedup and the efficiency are relative to one thread
+ */
+void runParallelQuickSortScaling() {
+    int maxThreads = max(1, (int) thread::hardware_concurrency());
+    vector<int> testArray(SCALING_SIZE);
+    vector<int> a;
+    FillRandomArray(testArray.data(), SCALING_SIZE, 1, 1000000000, false, 0);
+    vector<int> weakArray(WEAK_SCALING_SIZE * maxThreads);
+    FillRandomArray(weakArray.data(), (int) weakArray.size(), 1, 1000000000, false, 0);
+    long long strongBase = 0, weakBase = 0;
+    for (int threads = 1; threads <= maxThreads; threads = threads < maxThreads ? min(2 * threads, maxThreads) : threads + 1) {
+        Profiler local;
+        Operation dummy = local.createOperation("Dummy", 0);
+        WorkStealingPool pool(threads);
+
+        a = testArray;
+        auto start = chrono::steady_clock::now();
+        parallelQuickSort(a.data(), SCALING_SIZE, pool, dummy);
+        long long elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        strongBase = threads == 1 ? elapsed : strongBase;
+        profiler.createOperation("Strong Scaling Time", threads).count((int) elapsed);
+        profiler.createOperation("Strong Scaling Speedup", threads).count((int) (100 * strongBase / max(1LL, elapsed)));
+
+        int n = WEAK_SCALING_SIZE * threads;
+        a.assign(weakArray.begin(), weakArray.begin() + n);
+        start = chrono::steady_clock::now();
+        parallelQuickSort(a.data(), n, pool, dummy);
+        elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        weakBase = threads == 1 ? elapsed : weakBase;
+        profiler.createOperation("Weak Scaling Time", threads).count((int) elapsed);
+        profiler.createOperation("Weak Scaling Efficiency", threads).count((int) (100 * weakBase / max(1LL, elapsed)));
+    }
+    profiler.createGroup("Parallel Quick Sort Time", "Strong Scaling Time", "Weak Scaling Time");
+    profiler.createGroup("Parallel Quick Sort Speedup", "Strong Scaling Speedup", "Weak Scaling Efficiency");
+}
+
+/** Records the millions of elements per second of a kernel, a partition around the median value of the array or a sort
+ */
+template<typename T, typename Kernel>
+void measurePartitionThroughput(const vector<T> &testArray, int n, const char *series, Kernel kernel) {
+    vector<T> a(testArray.begin(), testArray.begin() + n);
+    T pivot = a[n / 2];
+    auto start = chrono::steady_clock::now();
+    int boundary = kernel(a.data(), n, pivot);
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+    profiler.createOperation(series, n >> 10).count((int) (n / max(1LL, (long long) elapsed.count())));
+    if (boundary < 0 || boundary > n) {
+        cout << series << " failed" << endl;
+    }
+}
+
+/** Partition throughput of the scalar, block and SIMD kernels on int arrays and of the scalar and SIMD kernels on
+ *  float arrays, the x axis is the size in thousands of elements
+ */
+void runPartitionThroughputTests() {
+    vector<int> integers(PARTITION_THROUGHPUT_MAX_SIZE);
+    FillRandomArray(integers.data(), PARTITION_THROUGHPUT_MAX_SIZE, 1, 1000000000, false, 0);
+    vector<float> floats(integers.begin(), integers.end());
+    Profiler local;
+    Operation dummy = local.createOperation("Dummy", 0);
+    for (int n = 1 << 16; n <= PARTITION_THROUGHPUT_MAX_SIZE; n <<= 2) {
+        measurePartitionThroughput(integers, n, "Lomuto Partition Throughput", [&](int *a, int size, int pivot) {
+            int i = -1;
+            for (int j = 0; j < size; j++) {
+                if (a[j] < pivot) {
+                    swap(a[++i], a[j]);
+                }
+            }
+            return i + 1;
+        });
+        measurePartitionThroughput(integers, n, "Block Partition Throughput", [&](int *a, int size, int pivot) {
+            return blockPartitionRange(a, 0, size - 1, pivot, dummy);
+        });
+        measurePartitionThroughput(integers, n, "SIMD Partition Throughput", [](int *a, int size, int pivot) {
+            return partitionRangeSimd(a, 0, size - 1, pivot);
+        });
+        measurePartitionThroughput(floats, n, "Scalar Float Partition Throughput", [](float *a, int size, float pivot) {
+            return partitionRangeScalar(a, 0, size - 1, pivot);
+        });
+        measurePartitionThroughput(floats, n, "SIMD Float Partition Throughput", [](float *a, int size, float pivot) {
+            return partitionRangeSimd(a, 0, size - 1, pivot);
+        });
+        measurePartitionThroughput(integers, n, "SIMD Quick Sort Throughput", [](int *a, int size, int) {
+            simdQuickSort(a, 0, size - 1);
+            return 0;
+        });
+        measurePartitionThroughput(floats, n, "SIMD Float Quick Sort Throughput", [](float *a, int size, float) {
+            simdQuickSort(a, 0, size - 1);
+            return 0;
+        });
+    }
+    profiler.createGroup("Partition Throughput", "Lomuto Partition Throughput", "Block Partition Throughput",
+                         "SIMD Partition Throughput", "Scalar Float Partition Throughput",
+                         "SIMD Float Partition Throughput");
+    profiler.createGroup("SIMD Quick Sort Throughput", "SIMD Quick Sort Throughput",
+                         "SIMD Float Quick Sort Throughput");
+}
+
+/** Running time ( nanoseconds per array ) of insertion sort and of the in-register sorting network on
+ *  SMALL_SORT_REPETITIONS random arrays of every size up to SMALL_NETWORK_MAX_SIZE, the small sorts of simdQuickSort
+ */
+void runSmallSortTests() {
+    vector<int> testArray(SMALL_SORT_REPETITIONS * SMALL_NETWORK_MAX_SIZE);
+    FillRandomArray(testArray.data(), (int) testArray.size(), 1, 1000000000, false, 0);
+    vector<int> a;
+    for (int n = 4; n <= SMALL_NETWORK_MAX_SIZE; n += 4) {
+        a = testArray;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < SMALL_SORT_REPETITIONS; i++) {
+            insertionSortUncounted(a.data() + i * n, 0, n - 1);
+        }
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        Operation insertionTime = profiler.createOperation("Insertion Small Sort Time", n);
+        insertionTime.count((int) (elapsed.count() / SMALL_SORT_REPETITIONS));
+
+        a = testArray;
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < SMALL_SORT_REPETITIONS; i++) {
+            smallSort(a.data() + i * n, 0, n - 1);
+        }
+        elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        Operation networkTime = profiler.createOperation("Network Small Sort Time", n);
+        networkTime.count((int) (elapsed.count() / SMALL_SORT_REPETITIONS));
+    }
+    profiler.createGroup("Small Sort Time", "Insertion Small Sort Time", "Network Small Sort Time");
+}
+
+/** Time ( microseconds ) of the recursive and the iterative Quick-Sort with the median of three on random and
+ *  descending arrays, the x axis is the size in thousands of elements
+ */
+void runIterativeQuickSortTests() {
+    Profiler local;
+    Operation dummy = local.createOperation("Dummy", 0);
+    vector<int> testArray(ITERATIVE_MAX_SIZE), a;
+    for (int shape = 0; shape < 2; shape++) {
+        FillRandomArray(testArray.data(), ITERATIVE_MAX_SIZE, 1, 1000000000, false, shape == 0 ? 0 : 2);
+        string input = shape == 0 ? " Random" : " Descending";
+        for (int n = 1 << 16; n <= ITERATIVE_MAX_SIZE; n <<= 1) {
+            a.assign(testArray.begin(), testArray.begin() + n);
+            auto start = chrono::steady_clock::now();
+            quickSortPolicy<MedianOfThreePivot>(a.data(), 0, n - 1, dummy);
+            auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+            profiler.createOperation(("Recursive Quick Sort" + input).c_str(), n >> 10).count((int) elapsed.count());
+
+            a.assign(testArray.begin(), testArray.begin() + n);
+            start = chrono::steady_clock::now();
+            quickSortIterative<MedianOfThreePivot>(a.data(), 0, n - 1, dummy);
+            elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+            profiler.createOperation(("Iterative Quick Sort" + input).c_str(), n >> 10).count((int) elapsed.count());
+            if (!IsSorted(a.data(), n)) {
+                cout << "Iterative Quick-Sort failed" << endl;
+            }
+        }
+    }
+    profiler.createGroup("Iterative Quick Sort Time", "Recursive Quick Sort Random", "Iterative Quick Sort Random",
+                         "Recursive Quick Sort Descending", "Iterative Quick Sort Descending");
+}
+
+/** Time ( microseconds ) of Quick-Sort with a random pivot and the two Heap-Sorts on random arrays, the x axis is the
+ *  size in thousands of elements
+ */
+void runHeapSortTimeTests() {
+    Profiler local;
+    Operation dummy = local.createOperation("Dummy", 0);
+    vector<int> testArray(HEAP_SORT_TIME_MAX_SIZE), a;
+    FillRandomArray(testArray.data(), HEAP_SORT_TIME_MAX_SIZE, 1, 1000000000, false, 0);
+    for (int n = 1 << 16; n <= HEAP_SORT_TIME_MAX_SIZE; n <<= 1) {
+        for (int s = 0; s < 3; s++) {
+            a.assign(testArray.begin(), testArray.begin() + n);
+            auto start = chrono::steady_clock::now();
+            if (s == 0) {
+                quickSortRandom(a.data(), 0, n - 1, dummy);
+            } else if (s == 1) {
+                heapSort(a.data(), n, dummy);
+            } else {
+                bottomUpHeapSort(a.data(), n, dummy);
+            }
+            auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+            const char *series[] = {"Quick Sort Time", "Heap Sort Time", "Bottom-Up Heap Sort Time"};
+            profiler.createOperation(series[s], n >> 10).count((int) elapsed.count());
+            if (!IsSorted(a.data(), n)) {
+                cout << series[s] << " failed" << endl;
+            }
+        }
+    }
+    profiler.createGroup("Heap Sort Time", "Quick Sort Time", "Heap Sort Time", "Bottom-Up Heap Sort Time");
+}
+
+/** Searches the median of random arrays from 2^20 to SELECTION_MAX_SIZE elements with every selection algorithm, the
+ *  operations and the time ( microseconds ) are recorded
+ */
+void runSelectionTests() {
+    vector<int> testArray(SELECTION_MAX_SIZE);
+    vector<int> a;
+    FillRandomArray(testArray.data(), SELECTION_MAX_SIZE, 1, 1000000000, false, 0);
+    const char *names[] = {"Quick Select", "Intro Select", "Floyd-Rivest", "nth_element"};
+    for (int n = 1 << 20; n <= SELECTION_MAX_SIZE; n <<= 1) {
+        int k = n / 2;
+        int sizeInK = n >> 10;
+        int results[4] = {};
+        for (int algorithm = 0; algorithm < 4; algorithm++) {
+            a.assign(testArray.begin(), testArray.begin() + n);
+            Profiler local;
+            Operation op = local.createOperation("Select", 0);
+            auto start = chrono::steady_clock::now();
+            int &result = results[algorithm];
+            switch (algorithm) {
+                case 0:
+                    result = quickSelectFind(a.data(), 0, n - 1, k, op);
+                    break;
+                case 1:
+                    result = a[introSelect(a.data(), 0, n - 1, k, op)];
+                    break;
+                case 2:
+                    result = a[floydRivestSelect(a.data(), 0, n - 1, k, op)];
+                    break;
+                default:
+                    nth_element(a.begin(), a.begin() + k, a.end());
+                    result = a[k];
+                    break;
+            }
+            auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+            profiler.createOperation((string(names[algorithm]) + " Time").c_str(), sizeInK).count((int) elapsed.count());
+            if (algorithm < 3) {
+                profiler.createOperation(names[algorithm], sizeInK).count(op.get());
+            }
+        }
+        if (results[0] != results[3] || results[1] != results[3] || results[2] != results[3]) {
+            cout << "Selection results differ for " << n << " elements" << endl;
+        }
+    }
+    profiler.createGroup("Selection", "Quick Select", "Intro Select", "Floyd-Rivest");
+    profiler.createGroup("Selection Time", "Quick Select Time", "Intro Select Time", "Floyd-Rivest Time",
+                         "nth_element Time");
+}
+
+/** Searches the 50th, 90th, 99th and 99.9th percentiles with multiSelect and with one Quick-Select call for each, the
+ *  operations and the time ( microseconds ) are recorded, the x axis is the size in thousands of elements
+ */
+void runMultiSelectTests() {
+    vector<int> testArray(MULTI_SELECT_MAX_SIZE);
+    vector<int> a;
+    FillRandomArray(testArray.data(), MULTI_SELECT_MAX_SIZE, 1, 1000000000, false, 0);
+    for (int n = 1 << 16; n <= MULTI_SELECT_MAX_SIZE; n <<= 1) {
+        vector<int> ranks = {n / 2, (int) (n * 0.9), (int) (n * 0.99), (int) (n * 0.999)};
+        int sizeInK = n >> 10;
+
+        a.assign(testArray.begin(), testArray.begin() + n);
+        Operation multi = profiler.createOperation("Multi Select", sizeInK);
+        auto start = chrono::steady_clock::now();
+        vector<int> percentiles = multiSelect(a.data(), n, ranks, multi);
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation("Multi Select Time", sizeInK).count((int) elapsed.count());
+
+        a.assign(testArray.begin(), testArray.begin() + n);
+        Operation repeated = profiler.createOperation("Repeated Quick Select", sizeInK);
+        start = chrono::steady_clock::now();
+        bool same = true;
+        for (size_t i = 0; i < ranks.size(); i++) {
+            same = same && quickSelectFind(a.data(), 0, n - 1, ranks[i], repeated) == percentiles[i];
+        }
+        elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        profiler.createOperation("Repeated Quick Select Time", sizeInK).count((int) elapsed.count());
+        if (!same) {
+            cout << "Multi-Select results differ for " << n << " elements" << endl;
+        }
+    }
+    profiler.createGroup("Multi Select", "Multi Select", "Repeated Quick Select");
+    profiler.createGroup("Multi Select Time", "Multi Select Time", "Repeated Quick Select Time");
+}
+
+/** Median time ( microseconds ) of the sort on TUNING_REPETITIONS copies of the test array
+ */
+template<typename Sort>
+long long measureTuningCandidate(const vector<int> &testArray, Sort sort) {
+    vector<long long> times;
+    vector<int> a;
+    for (int r = 0; r < TUNING_REPETITIONS; r++) {
+        a = testArray;
+        auto start = chrono::steady_clock::now();
+        sort(a.data(), (int) a.size());
+        times.push_back(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+        if (!IsSorted(a.data(), (int) a.size())) {
+            cout << "Tuning sort failed" << endl;
+        }
+    }
+    nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+/** Tries every candidate value of the parameter and keeps the fastest one
+ */
+template<typename Sort>
+void tuneParameter(const char *name, int &parameter, const vector<int> &candidates, const vector<int> &testArray,
+                   Sort sort) {
+    int best = parameter;
+    long long bestTime = LLONG_MAX;
+    for (int candidate : candidates) {
+        parameter = candidate;
+        long long time = measureTuningCandidate(testArray, sort);
+        cout << name << "\t" << candidate << "\t" << time << " us" << endl;
+        if (time < bestTime) {
+            bestTime = time;
+            best = candidate;
+        }
+    }
+    parameter = best;
+    cout << name << " = " << best << endl << endl;
+}
+
+/** Searches the parameters of the hybrid sorts on this machine one after the other ( each with the best values of
+ *  the previous ones ) and saves them to TUNING_FILE
+ */
+void runTuner() {
+    vector<int> testArray(TUNING_SIZE);
+    FillRandomArray(testArray.data(), TUNING_SIZE, 1, 1000000000, false, 0);
+    Profiler local;
+    Operation dummy = local.createOperation("Dummy", 0);
+    auto pdq = [&](int *a, int n) {
+        pdqSort(a, n, dummy);
+    };
+    tuneParameter("insertion_sort_cutoff", sortParameters.insertionSortCutoff, {4, 8, 12, 16, 24, 32, 48, 64},
+                  testArray, pdq);
+    tuneParameter("network_sort_cutoff", sortParameters.networkSortCutoff, {8, 16, 24, 32, 48, 64}, testArray,
+                  [](int *a, int n) {
+                      simdQuickSort(a, 0, n - 1);
+                  });
+    tuneParameter("block_size", sortParameters.blockSize, {32, 64, 96, 128, 192, 256}, testArray, pdq);
+    tuneParameter("ninther_threshold", sortParameters.nintherThreshold, {32, 64, 128, 256, 512, 1024}, testArray,
+                  pdq);
+    WorkStealingPool pool(max(1, (int) thread::hardware_concurrency()));
+    tuneParameter("parallel_grain_size", sortParameters.parallelGrainSize,
+                  {1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18}, testArray, [&](int *a, int n) {
+                parallelQuickSort(a, n, pool, dummy);
+            });
+    if (saveSortParameters(TUNING_FILE)) {
+        cout << "Saved to " << TUNING_FILE << endl;
+    } else {
+        cout << "Could not write " << TUNING_FILE << endl;
+    }
+}
+
+void runTests() {
+    BranchMissCounter counter;
+    if (!counter.available()) {
+        cout << "Hardware branch miss counters are not available, only the running times are measured" << endl;
+    }
+    for (int i = 100; i <= 10000; i += 100) {
+        worstCase(i);
+        bestCase(i);
+        for (int j = 0; j < 5; j++) {
+            averageCase(i);
+        }
+        fewUniqueCase(i);
+        allEqualCase(i);
+        partitionBranchCase(i, counter);
+        pdqCase(i);
+    }
+    for (int i = 100; i <= 10000; i += 500) {
+        pivotCase(i);
+        antiQsortCase(i);
+    }
+    profiler.divideValues("Average Quick Sort", 5);
+    profiler.divideValues("Average Heap Sort", 5);
+    profiler.divideValues("Average Sample Sort", 5);
+    profiler.divideValues("Average Intro Sort", 5);
+    profiler.divideValues("Average Bottom-Up Heap Sort", 5);
+    runSampleSortScaling();
+    runParallelQuickSortScaling();
+    runIterativeQuickSortTests();
+    runHeapSortTimeTests();
+    runSelectionTests();
+    runMultiSelectTests();
+    runPartitionThroughputTests();
+    runSmallSortTests();
+    profiler.createGroup("Average Case", "Average Quick Sort", "Average Heap Sort", "Average Intro Sort",
+                         "Average Bottom-Up Heap Sort");
+    profiler.createGroup("Average Case Sample Sort", "Average Quick Sort", "Average Sample Sort");
+    profiler.createGroup("Best Case", "Best Quick Sort", "Best Heap Sort");
+    profiler.createGroup("Worst Case", "Worst Quick Sort", "Worst Heap Sort", "Worst Intro Sort");
+    profiler.createGroup("Worst Case Iterative", "Worst Quick Sort", "Worst Iterative Quick Sort");
+    createPartitionGroups("Few Unique");
+    createPartitionGroups("All Equal");
+    profiler.createGroup("Partition Branch Misses", "Lomuto Branch Misses", "Block Branch Misses");
+    profiler.createGroup("Partition Time", "Lomuto Partition Time", "Block Partition Time");
+    createPdqGroups();
+    createPivotGroups();
+    createAntiQsortGroups();
+    profiler.showReport();
+}
+
+void exemplifyCorrectness(int n) {
+    int testArray[MAX_SIZE];
+    FillRandomArray(testArray, n, 1, 10, true, 2);
     Operation dummy = profiler.createOperation("Dummy", 0);
     cout<<"Quick-Sort:"<<endl;
     printArray(testArray, n);
     quickSortBestCase(testArray, 0, n - 1, dummy);
     printArray(testArray, n);
+    cout << "Iterative Quick-Sort:" << endl;
+    FillRandomArray(testArray, n, 1, 10, true, 2);
+    printArray(testArray, n);
+    quickSortIterative<LastPivot>(testArray, 0, n - 1, dummy);
+    printArray(testArray, n);
+    cout << "Bottom-Up Heap-Sort:" << endl;
+    FillRandomArray(testArray, n, 1, 10, false, 0);
+    printArray(testArray, n);
+    bottomUpHeapSort(testArray, n, dummy);
+    printArray(testArray, n);
     cout<<"Quick-Select (5th smallest element):"<<endl;
-    cout << quickSelect(testArray, 0, n - 1, 5, dummy);
+    cout << quickSelect(testArray, 0, n - 1, 5, dummy) << endl;
+    cout << "Median-of-Medians Quick-Select (5th smallest element):" << endl;
+    cout << testArray[quickSelectPolicy<MedianOfMediansPivot>(testArray, 0, n - 1, 4, dummy)] << endl;
+    cout << "Intro-Select and Floyd-Rivest (5th smallest element):" << endl;
+    cout << testArray[introSelect(testArray, 0, n - 1, 4, dummy)] << " "
+         << testArray[floydRivestSelect(testArray, 0, n - 1, 4, dummy)] << endl;
+    cout << "Multi-Select (2nd, 5th and 9th smallest elements):" << endl;
+    FillRandomArray(testArray, n, 1, 100, false, 0);
+    printArray(testArray, n);
+    vector<int> selected = multiSelect(testArray, n, {1, 4, 8}, dummy);
+    cout << selected[0] << " " << selected[1] << " " << selected[2] << endl;
+
+    cout << "Antiqsort killer input for the Median-of-3 pivot:" << endl;
+    vector<int> killer = antiQsort(n, [](AdversaryKey keys[], int size, Operation op) {
+        quickSortPolicy<MedianOfThreePivot>(keys, 0, size - 1, op);
+    }, dummy);
+    printArray(killer.data(), n);
+
+    cout << "PDQ-Sort:" << endl;
+    FillRandomArray(testArray, n, 1, 10, false, 0);
+    printArray(testArray, n);
+    pdqSort(testArray, n, dummy);
+    printArray(testArray, n);
+
+    cout << "Intro-Sort:" << endl;
+    FillRandomArray(testArray, n, 1, 10, false, 0);
+    printArray(testArray, n);
+    introSort(testArray, n, dummy);
+    printArray(testArray, n);
+
+    for (int s = 0; s < NR_PARTITION_STRATEGIES; s++) {
+        cout << partitionStrategyNames[s] << " partition Quick-Sort:" << endl;
+        FillRandomArray(testArray, n, 1, 3, false, 0);
+        printArray(testArray, n);
+        quickSortStrategy(testArray, 0, n - 1, (PartitionStrategy) s, dummy);
+        printArray(testArray, n);
+    }
+
+    cout << "SIMD Quick-Sort of floats with infinities:" << endl;
+    vector<float> floats = {INFINITY, -INFINITY, 2.5f, -1.0f, INFINITY, 0.0f, -INFINITY, 7.0f, 3.0f, INFINITY};
+    for (float x : floats) {
+        cout << x << " ";
+    }
+    cout << endl;
+    simdQuickSort(floats.data(), 0, (int) floats.size() - 1);
+    for (float x : floats) {
+        cout << x << " ";
+    }
+    cout << endl;
+    vector<float> infinities(40, INFINITY);
+    for (int i = 0; i < (int) infinities.size(); i += 3) {
+        infinities[i] = i % 2 ? -INFINITY : (float) i;
+    }
+    simdQuickSort(infinities.data(), 0, (int) infinities.size() - 1);
+    bool sortedFloats = count(infinities.begin(), infinities.end(), INFINITY) == 26;
+    for (int i = 1; i < (int) infinities.size(); i++) {
+        sortedFloats = sortedFloats && !(infinities[i] < infinities[i - 1]);
+    }
+    cout << "SIMD Quick-Sort on " << infinities.size() << " floats with 26 infinities: "
+         << (sortedFloats ? "sorted" : "NOT sorted") << endl;
+
+    vector<int> large(4 * SAMPLE_SORT_CUTOFF);
+    FillRandomArray(large.data(), (int) large.size(), 1, 100, false, 0);
+    ThreadPool pool(4);
+    sampleSort(large.data(), (int) large.size(), pool, dummy);
+    cout << "Sample-Sort on " << large.size() << " elements with 4 threads: "
+         << (IsSorted(large.data(), (int) large.size()) ? "sorted" : "NOT sorted") << endl;
+
+    large.resize(2 * PARALLEL_PARTITION_SIZE);
+    FillRandomArray(large.data(), (int) large.size(), 1, 1000000, false, 0);
+    WorkStealingPool stealingPool(4);
+    parallelQuickSort(large.data(), (int) large.size(), stealingPool, dummy);
+    cout << "Work-Stealing Quick-Sort on " << large.size() << " elements with 4 threads: "
+         << (IsSorted(large.data(), (int) large.size()) ? "sorted" : "NOT sorted") << endl;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && string(argv[1]) == "--tune") {
+        runTuner();
+        return 0;
+    }
+    if (loadSortParameters(TUNING_FILE)) {
+        cout << "Using the tuned parameters from " << TUNING_FILE << endl;
+    }
     runTests();
     exemplifyCorrectness(10);
     return 0;
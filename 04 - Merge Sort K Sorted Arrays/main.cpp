@@ -32,14 +32,34 @@
  *               It equals with O(n), but it's a nice thing to have.
  *              In conclusion we have O(n * log(k))
  *
- *
- *
+ *      *External Merge Sort*
+ *          For files of keys which are larger than the memory, the same k-way merge is done on files instead of arrays.
+ *          Algorithm:
+ *              Run generation: the input is read in chunks that fit in the memory budget, each chunk is sorted with
+ *               Heap-Sort ( O(n*log n) in the worst case and no deep recursion on huge chunks ) and written to a
+ *               temporary file, so we get k = fileSize / memoryBudget sorted runs.
+ *              Merging: each run gets an equal share of the memory budget as its read buffer, and the heap from above
+ *               picks the smallest head among the runs. If there are so many runs that the buffers would be smaller than
+ *               MIN_MERGE_BUFFER, the runs are merged in more passes, fanIn runs at a time.
+ *              All the reads and writes go through our own big buffers and the C library buffering is turned off, so
+ *               every fread/fwrite moves a whole buffer straight to/from the file.
+ *          Run Time:
+ *              O(n * log n) comparisons, and the file is read and written 2 times ( 1 + number of merge passes ) in total.
+ *              The throughput ( MB/s ) is reported as a function of the file size and of the memory budget.
  */
 
 #include <iostream>
 #include <vector>
+#include <cstdio>
+#include <chrono>
+#include <functional>
 #include "Profiler.h"
 
+#define MEGABYTE (1 << 20)
+#define MIN_MERGE_BUFFER 4096
+#define EXTERNAL_BUDGET_MB 4
+#define EXTERNAL_FILE_MB 32
+
 Profiler profiler("QuickSort Advanced Analysis");
 
 using namespace std;
@@ -62,25 +82,36 @@ int getRightChildIndex(int i) {
     return (2 * i + 2);
 }
 
-void heapifyDown(vector<doublePair> &data, int i, Operation op) {
-    int leftChildIndex = getLeftChildIndex(i);
-    int rightChildIndex = getRightChildIndex(i);
-    op.count(1);
-    if (rightChildIndex < data.size() && (data[rightChildIndex] < data[i]) &&
-        (data[rightChildIndex] < data[leftChildIndex])) {
-        data[rightChildIndex].swap(data[i]);
-        op.count(3);
-        heapifyDown(data, rightChildIndex, op);
-    } else {
-        if (leftChildIndex < data.size() && data[leftChildIndex] < data[i]) {
-            op.count(1);
-            data[leftChildIndex].swap(data[i]);
-            op.count(3);
-            heapifyDown(data, leftChildIndex, op);
-        } else if (leftChildIndex < data.size()) {
-            op.count(1);
+/** Moves the element at i down to its place in the heap a[0..n-1] without recursion. The element is carried as a
+ *  hole and written only once at the end, so every level costs one move instead of a swap.
+ *
+ * @param before    before(x, y) is true if x has to be closer to the root than y, greater<T>() for a max-heap and
+ *                  less<T>() for a min-heap
+ */
+template<typename T, typename Compare>
+void siftDown(T a[], int i, int n, Compare before, Operation op) {
+    op.count();
+    T x = a[i];
+    int child = getLeftChildIndex(i);
+    while (child < n) {
+        int rightChildIndex = getRightChildIndex(i);
+        if (rightChildIndex < n) {
+            op.count();
+            if (before(a[rightChildIndex], a[child])) {
+                child = rightChildIndex;
+            }
         }
+        op.count();
+        if (!before(a[child], x)) {
+            break;
+        }
+        op.count();
+        a[i] = a[child];
+        i = child;
+        child = getLeftChildIndex(i);
     }
+    op.count();
+    a[i] = x;
 }
 
 void pop(vector<doublePair> &data, Operation op) {
@@ -89,27 +120,279 @@ void pop(vector<doublePair> &data, Operation op) {
     data[0].swap(data[data.size() - 1]);
     op.count(3);
     data.pop_back();
-    heapifyDown(data, 0, op);
+    if (!data.empty()) {
+        siftDown(data.data(), 0, (int) data.size(), less<doublePair>(), op);
+    }
 //    return pair;
 }
 
-void heapifyUp(vector<doublePair> &data, int i, Operation op) {
-    int parentIndex = getParentIndex(i);
-    if (parentIndex != -1 && data[parentIndex] > data[i]) {
-        op.count(1);
-        data[parentIndex].swap(data[i]);
+void switchFirst(vector<doublePair> &data, doublePair what, Operation op) {
+    data[0] = what;
+    siftDown(data.data(), 0, (int) data.size(), less<doublePair>(), op);
+}
+
+void heapSort(int a[], int n, Operation op) {
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        siftDown(a, i, n, greater<int>(), op);
+    }
+    for (int i = n - 1; i > 0; i--) {
         op.count(3);
-        heapifyUp(data, parentIndex, op);
-    } else if (parentIndex == -1) {
-        op.count(1);
+        swap(a[0], a[i]);
+        siftDown(a, 0, i, greater<int>(), op);
     }
 }
 
-void switchFirst(vector<doublePair> &data, doublePair what, Operation op) {
-    data[0].swap(what);
-    heapifyDown(data, 0, op);
-//    data.push_back(what);
-//    heapifyUp(data, data.size() - 1, op);
+/** Reads a binary file of ints through a buffer of fixed size
+ */
+typedef struct {
+    FILE *file;
+    vector<int> buffer;
+    size_t position;
+    size_t size;
+    bool failed;
+} RunReader;
+
+/** Writes a binary file of ints through a buffer of fixed size
+ */
+typedef struct {
+    FILE *file;
+    vector<int> buffer;
+    size_t size;
+} RunWriter;
+
+/** Opens a temporary file for a run, unbuffered because the readers and the writer do their own buffering
+ *  setvbuf is only allowed before the first operation on the stream, so it is called right after tmpfile
+ */
+FILE *createRun() {
+    FILE *run = tmpfile();
+    if (run != NULL) {
+        setvbuf(run, NULL, _IONBF, 0);
+    }
+    return run;
+}
+
+void openReader(RunReader &reader, FILE *file, size_t bufferElements) {
+    reader.file = file;
+    reader.buffer.resize(bufferElements);
+    reader.position = 0;
+    reader.size = 0;
+    reader.failed = false;
+}
+
+void openWriter(RunWriter &writer, FILE *file, size_t bufferElements) {
+    writer.file = file;
+    writer.buffer.resize(bufferElements);
+    writer.size = 0;
+}
+
+bool readNext(RunReader &reader, int &value) {
+    if (reader.position == reader.size) {
+        reader.size = fread(reader.buffer.data(), sizeof(int), reader.buffer.size(), reader.file);
+        reader.position = 0;
+        if (reader.size == 0) {
+            // a read error looks like the end of the run, the merge checks failed to tell them apart
+            reader.failed = ferror(reader.file) != 0;
+            return false;
+        }
+    }
+    value = reader.buffer[reader.position++];
+    return true;
+}
+
+bool flushWriter(RunWriter &writer) {
+    size_t written = fwrite(writer.buffer.data(), sizeof(int), writer.size, writer.file);
+    bool complete = written == writer.size;
+    writer.size = 0;
+    return complete;
+}
+
+bool writeNext(RunWriter &writer, int value) {
+    writer.buffer[writer.size++] = value;
+    if (writer.size == writer.buffer.size()) {
+        return flushWriter(writer);
+    }
+    return true;
+}
+
+/** Reads the input in chunks of chunkElements, sorts them with Heap-Sort and writes each one into a temporary file
+ *
+ * @param input
+ * @param chunkElements     Number of ints that fit in the memory budget
+ * @param runs              The temporary files, rewound, ready to be read
+ * @param op
+ * @return                  false if the input couldn't be read or a temporary file couldn't be created or written
+ */
+bool generateRuns(FILE *input, size_t chunkElements, vector<FILE *> &runs, Operation op) {
+    vector<int> chunk(chunkElements);
+    size_t size;
+    while ((size = fread(chunk.data(), sizeof(int), chunkElements, input)) > 0) {
+        heapSort(chunk.data(), (int) size, op);
+        FILE *run = createRun();
+        if (run == NULL) {
+            return false;
+        }
+        runs.push_back(run);
+        if (fwrite(chunk.data(), sizeof(int), size, run) != size) {
+            return false;
+        }
+        rewind(run);
+    }
+    return ferror(input) == 0;
+}
+
+void closeRuns(vector<FILE *> &runs) {
+    for (FILE *run : runs) {
+        fclose(run);
+    }
+    runs.clear();
+}
+
+/** Merges the sorted runs into output with the min-heap, the runs are closed ( and deleted ) at the end
+ *
+ * @param runs
+ * @param output
+ * @param memoryElements    The memory budget in ints, shared equally by the read buffers and the write buffer
+ * @param op
+ * @return                  false if a run couldn't be read or the output couldn't be written
+ */
+bool mergeRunFiles(vector<FILE *> runs, FILE *output, size_t memoryElements, Operation op) {
+    int k = runs.size();
+    size_t bufferElements = max((size_t) MIN_MERGE_BUFFER, memoryElements / (k + 1));
+    vector<RunReader> readers(k);
+    vector<doublePair> heap;
+    heap.reserve(k);
+    for (int i = 0; i < k; i++) {
+        openReader(readers[i], runs[i], bufferElements);
+        int value;
+        if (readNext(readers[i], value)) {
+            heap.push_back({value, {i, 0}});
+        }
+    }
+    for (int i = (int) heap.size() / 2 - 1; i >= 0; i--) {
+        siftDown(heap.data(), i, (int) heap.size(), less<doublePair>(), op);
+    }
+    RunWriter writer;
+    openWriter(writer, output, bufferElements);
+    bool written = true;
+    while (written && !heap.empty()) {
+        doublePair min = heap.at(0);
+        written = writeNext(writer, min.first);
+        int i = min.second.first;
+        int value;
+        if (readNext(readers[i], value)) {
+            switchFirst(heap, {value, {i, 0}}, op);
+        } else {
+            pop(heap, op);
+        }
+    }
+    written = written && flushWriter(writer);
+    for (const RunReader &reader : readers) {
+        written = written && !reader.failed;
+    }
+    closeRuns(runs);
+    return written;
+}
+
+/** Sorts a binary file of ints which may be larger than the memory
+ *  Method implemented: External Merge Sort ( Heap-Sorted runs + k-way merge with a min-heap )
+ *
+ * @param inputPath
+ * @param outputPath
+ * @param memoryBudget      Bytes of memory that the sort may use for its buffers
+ * @param op
+ * @return                  false if a file couldn't be opened, created or written
+ */
+bool externalSort(const char *inputPath, const char *outputPath, size_t memoryBudget, Operation op) {
+    size_t memoryElements = max((size_t) 2 * MIN_MERGE_BUFFER, memoryBudget / sizeof(int));
+    FILE *input = fopen(inputPath, "rb");
+    if (input == NULL) {
+        return false;
+    }
+    setvbuf(input, NULL, _IONBF, 0);
+    vector<FILE *> runs;
+    bool generated = generateRuns(input, memoryElements, runs, op);
+    fclose(input);
+    if (!generated) {
+        closeRuns(runs);
+        return false;
+    }
+
+    size_t fanIn = max((size_t) 2, memoryElements / MIN_MERGE_BUFFER - 1);
+    while (runs.size() > fanIn) {
+        vector<FILE *> merged;
+        size_t i;
+        bool failed = false;
+        for (i = 0; !failed && i < runs.size(); i += fanIn) {
+            vector<FILE *> group(runs.begin() + i, runs.begin() + min(runs.size(), i + fanIn));
+            FILE *run = group.size() == 1 ? group[0] : createRun();
+            if (run == NULL) {
+                break;
+            }
+            merged.push_back(run);
+            if (group.size() > 1) {
+                // the merge closes the group even when it fails, so i still moves past it
+                failed = !mergeRunFiles(group, run, memoryElements, op);
+                rewind(run);
+            }
+        }
+        if (failed || i < runs.size()) {
+            vector<FILE *> unmerged(runs.begin() + min(i, runs.size()), runs.end());
+            closeRuns(unmerged);
+            closeRuns(merged);
+            return false;
+        }
+        runs.swap(merged);
+    }
+
+    FILE *output = fopen(outputPath, "wb");
+    if (output == NULL) {
+        closeRuns(runs);
+        return false;
+    }
+    setvbuf(output, NULL, _IONBF, 0);
+    bool written = mergeRunFiles(runs, output, memoryElements, op);
+    return fclose(output) == 0 && written;
+}
+
+/** Writes a binary file of size megabytes of random ints
+ *
+ * @return  false if the file couldn't be created or written
+ */
+bool generateKeyFile(const char *path, int megabytes) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    vector<int> chunk(MEGABYTE / sizeof(int));
+    bool written = true;
+    for (int i = 0; written && i < megabytes; i++) {
+        FillRandomArray(chunk.data(), (int) chunk.size(), 0, 1000000000, false, 0);
+        written = fwrite(chunk.data(), sizeof(int), chunk.size(), file) == chunk.size();
+    }
+    return fclose(file) == 0 && written;
+}
+
+/** Sorts a file of fileMegabytes with the given memory budget and returns the throughput in MB/s, or -1 if the input
+ *  couldn't be generated or the sort failed
+ */
+int measureExternalSort(int fileMegabytes, int budgetMegabytes) {
+    Profiler local;
+    Operation dummy = local.createOperation("Dummy", 0);
+    if (!generateKeyFile("external_input.bin", fileMegabytes)) {
+        cout << "Could not write external_input.bin" << endl;
+        remove("external_input.bin");
+        return -1;
+    }
+    auto start = chrono::steady_clock::now();
+    bool sorted = externalSort("external_input.bin", "external_output.bin", (size_t) budgetMegabytes * MEGABYTE, dummy);
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+    remove("external_input.bin");
+    remove("external_output.bin");
+    if (!sorted) {
+        cout << "External sort of " << fileMegabytes << " MB with " << budgetMegabytes << " MB failed" << endl;
+        return -1;
+    }
+    return (int) (1000LL * fileMegabytes / max(1LL, (long long) elapsed.count()));
 }
 
 void printVector(vector<int> data) {
@@ -132,8 +415,8 @@ vector<doublePair> makeHeap(vector<vector<int>> arrays, int k, Operation op) {
     for (int i = 0; i < k; i++) {
         heap.push_back({arrays[i][0], {i, 0}});
     }
-    for (int i = k / 2; i >= 0; i--) {
-        heapifyDown(heap, i, op);
+    for (int i = k / 2 - 1; i >= 0; i--) {
+        siftDown(heap.data(), i, k, less<doublePair>(), op);
     }
     return heap;
 }
@@ -167,6 +450,35 @@ void exemplifyCorrectness(int n, int k) {
     vector<int> result = mergeKSortedArrays(data, data.size(), dummy);
     cout << "Result:" << endl;
     printVector(result);
+
+    vector<int> keys = fillVector(n * k, 1, 100, false, 0);
+    cout << "External Sort ( memory budget for " << 2 * MIN_MERGE_BUFFER << " ints ):" << endl;
+    printVector(keys);
+    FILE *file = fopen("external_input.bin", "wb");
+    bool written = file != NULL && fwrite(keys.data(), sizeof(int), keys.size(), file) == keys.size();
+    if (file != NULL) {
+        written = fclose(file) == 0 && written;
+    }
+    if (!written) {
+        cout << "Could not write external_input.bin" << endl;
+    } else if (!externalSort("external_input.bin", "external_output.bin", 0, dummy)) {
+        cout << "External sort failed" << endl;
+    } else {
+        file = fopen("external_output.bin", "rb");
+        if (file == NULL) {
+            cout << "Could not read external_output.bin" << endl;
+        } else {
+            size_t size = fread(keys.data(), sizeof(int), keys.size(), file);
+            fclose(file);
+            if (size != keys.size()) {
+                cout << "external_output.bin has " << size << " of " << keys.size() << " ints" << endl;
+            }
+            keys.resize(size);
+            printVector(keys);
+        }
+    }
+    remove("external_input.bin");
+    remove("external_output.bin");
 }
 
 void generateChart(int n, int k, Operation op) {
@@ -195,6 +507,21 @@ void runTests() {
     }
     profiler.createGroup("Fixed Array Numbers - Different Array Size", "Five Arrays", "Ten Arrays", "Hundred Arrays");
     profiler.createGroup("Different Array Numbers - Fixed Array Size", "10.000 Array Size");
+    for (int megabytes = 1; megabytes <= 8 * EXTERNAL_FILE_MB; megabytes *= 2) {
+        int megabytesPerSecond = measureExternalSort(megabytes, EXTERNAL_BUDGET_MB);
+        // a failed sort leaves no point at all, creating the operation would already chart a 0
+        if (megabytesPerSecond >= 0) {
+            profiler.createOperation("External Sort MB per s - 4 MB Budget", megabytes).count(megabytesPerSecond);
+        }
+    }
+    for (int megabytes = 1; megabytes <= 2 * EXTERNAL_FILE_MB; megabytes *= 2) {
+        int megabytesPerSecond = measureExternalSort(EXTERNAL_FILE_MB, megabytes);
+        if (megabytesPerSecond >= 0) {
+            profiler.createOperation("External Sort MB per s - 32 MB File", megabytes).count(megabytesPerSecond);
+        }
+    }
+    profiler.createGroup("External Sort Throughput - Different File Size", "External Sort MB per s - 4 MB Budget");
+    profiler.createGroup("External Sort Throughput - Different Memory Budget", "External Sort MB per s - 32 MB File");
     profiler.showReport();
 }
 